@@ -0,0 +1,605 @@
+#include "CorpusGenerator.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFile>
+
+#include <QtGui/QImage>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace
+{
+    const auto trile_sets_dir = QString("trile sets");
+    const auto art_objects_dir = QString("art objects");
+    const auto levels_dir = QString("levels");
+    const auto planes_dir = QString("background planes");
+    const auto characters_dir = QString("character animations");
+
+    const auto export_dirs = QStringList{"ao_export", "ts_export", "lv_export", "flipbooks"};
+
+    QString numbered(const QString& prefix, const int& number)
+    {
+        return prefix + QString::number(number).rightJustified(3, '0');
+    }
+
+    // animated planes alternate with static ones
+    bool isAnimatedPlane(const int& plane)
+    {
+        return plane % 2 == 1;
+    }
+}
+
+CorpusGenerator::CorpusGenerator(const CorpusSettings& settings) : m_Settings{settings}, m_Random{settings.m_Seed}
+{
+}
+
+std::optional<CorpusStats> CorpusGenerator::generate(const QString& path)
+{
+    const auto root = QDir(path);
+
+    for(const auto& dir : {trile_sets_dir, art_objects_dir, levels_dir, planes_dir, characters_dir})
+    {
+        if(!root.mkpath(dir))
+            return {};
+    }
+
+    for(int i = 0; i < m_Settings.m_NumTrileSets; i++)
+    {
+        if(!writeTrileSet(root.filePath(trile_sets_dir), i))
+            return {};
+    }
+
+    for(int i = 0; i < m_Settings.m_NumArtObjects; i++)
+    {
+        if(!writeArtObject(root.filePath(art_objects_dir), i))
+            return {};
+    }
+
+    for(int i = 0; i < m_Settings.m_NumPlaneTextures; i++)
+    {
+        if(!writePlaneTexture(root.filePath(planes_dir), i))
+            return {};
+    }
+
+    for(int i = 0; i < m_Settings.m_NumCharacters; i++)
+    {
+        if(!writeCharacter(root.filePath(characters_dir), i))
+            return {};
+    }
+
+    // levels last, they draw from everything above
+    for(int i = 0; i < m_Settings.m_NumLevels; i++)
+    {
+        if(!writeLevel(root.filePath(levels_dir), i))
+            return {};
+    }
+
+    return measure(path);
+}
+
+CorpusStats CorpusGenerator::measure(const QString& path)
+{
+    auto result = CorpusStats();
+
+    for(const auto& dir : {trile_sets_dir, art_objects_dir, levels_dir, planes_dir, characters_dir})
+    {
+        auto file_iter = QDirIterator(QDir(path).filePath(dir), QDir::Filter::Files | QDir::Filter::NoDotAndDotDot, QDirIterator::Subdirectories);
+
+        while(file_iter.hasNext())
+        {
+            const auto file = file_iter.next();
+
+            result.m_Files++;
+            result.m_Bytes += file_iter.fileInfo().size();
+
+            if(dir != levels_dir || !file.endsWith(".xml"))
+                continue;
+
+            QFile level_file(file);
+
+            if(!level_file.open(QIODevice::OpenModeFlag::ReadOnly))
+                continue;
+
+            result.m_Levels++;
+            result.m_Emplacements += level_file.readAll().count("<TrileEmplacement ");
+        }
+    }
+
+    return result;
+}
+
+size_t CorpusGenerator::exportSize(const QString& path)
+{
+    auto result = size_t(0);
+
+    for(const auto& dir : export_dirs)
+    {
+        auto file_iter = QDirIterator(QDir(path).filePath(dir), QDir::Filter::Files | QDir::Filter::NoDotAndDotDot, QDirIterator::Subdirectories);
+
+        while(file_iter.hasNext())
+        {
+            file_iter.next();
+            result += file_iter.fileInfo().size();
+        }
+    }
+
+    return result;
+}
+
+void CorpusGenerator::clearExports(const QString& path)
+{
+    for(const auto& dir : export_dirs)
+        QDir(QDir(path).filePath(dir)).removeRecursively();
+
+    QFile::remove(QDir(path).filePath("dedupe_report.json"));
+}
+
+void CorpusGenerator::addOptions(QCommandLineParser& parser)
+{
+    const auto defaults = CorpusSettings();
+
+    parser.addOption(QCommandLineOption("levels", "Number of levels.", "count", QString::number(defaults.m_NumLevels)));
+    parser.addOption(QCommandLineOption("trile-sets", "Number of trile sets, levels use them round robin.", "count", QString::number(defaults.m_NumTrileSets)));
+    parser.addOption(QCommandLineOption("triles", "Triles per trile set.", "count", QString::number(defaults.m_TrilesPerSet)));
+    parser.addOption(QCommandLineOption("emplacements", "Trile emplacements per level.", "count", QString::number(defaults.m_EmplacementsPerLevel)));
+    parser.addOption(QCommandLineOption("art-objects", "Number of art objects.", "count", QString::number(defaults.m_NumArtObjects)));
+    parser.addOption(QCommandLineOption("art-objects-per-level", "Art object instances per level.", "count", QString::number(defaults.m_ArtObjectsPerLevel)));
+    parser.addOption(QCommandLineOption("art-object-detail", "Quads along every edge of an art object face.", "count", QString::number(defaults.m_ArtObjectDetail)));
+    parser.addOption(QCommandLineOption("plane-textures", "Number of background plane textures, every second one is animated.", "count", QString::number(defaults.m_NumPlaneTextures)));
+    parser.addOption(QCommandLineOption("planes", "Background planes per level.", "count", QString::number(defaults.m_PlanesPerLevel)));
+    parser.addOption(QCommandLineOption("characters", "Number of characters.", "count", QString::number(defaults.m_NumCharacters)));
+    parser.addOption(QCommandLineOption("characters-per-level", "Characters per level.", "count", QString::number(defaults.m_CharactersPerLevel)));
+    parser.addOption(QCommandLineOption("frames", "Frames per animated texture.", "count", QString::number(defaults.m_AnimationFrames)));
+    parser.addOption(QCommandLineOption("texture-size", "Edge length of every texture and animation frame, a multiple of 16.", "size", QString::number(defaults.m_TextureSize)));
+    parser.addOption(QCommandLineOption("seed", "Seed of the placement randomness.", "seed", QString::number(defaults.m_Seed)));
+}
+
+CorpusSettings CorpusGenerator::settings(const QCommandLineParser& parser)
+{
+    const auto count = [&parser](const QString& option, const int& minimum) -> int {
+        return std::max(parser.value(option).toInt(), minimum);
+    };
+
+    auto result = CorpusSettings();
+
+    result.m_NumLevels = count("levels", 0);
+    result.m_NumTrileSets = count("trile-sets", 1);
+    result.m_TrilesPerSet = count("triles", 1);
+    result.m_EmplacementsPerLevel = count("emplacements", 0);
+    result.m_NumArtObjects = count("art-objects", 1);
+    result.m_ArtObjectsPerLevel = count("art-objects-per-level", 0);
+    result.m_ArtObjectDetail = count("art-object-detail", 1);
+    result.m_NumPlaneTextures = count("plane-textures", 1);
+    result.m_PlanesPerLevel = count("planes", 0);
+    result.m_NumCharacters = count("characters", 1);
+    result.m_CharactersPerLevel = count("characters-per-level", 0);
+    result.m_AnimationFrames = count("frames", 1);
+    result.m_TextureSize = std::max(count("texture-size", 16) / 16 * 16, 16);
+    result.m_Seed = parser.value("seed").toUInt();
+
+    return result;
+}
+
+QDomDocument CorpusGenerator::trileSetDocument(const int& set)
+{
+    const auto name = numbered("set_", set);
+
+    QDomDocument document;
+
+    auto set_elem = document.createElement("TrileSet");
+    set_elem.setAttribute("name", name);
+    document.appendChild(set_elem);
+
+    auto triles_elem = document.createElement("Triles");
+    set_elem.appendChild(triles_elem);
+
+    for(int key = 0; key < m_Settings.m_TrilesPerSet; key++)
+    {
+        auto entry_elem = document.createElement("TrileEntry");
+        entry_elem.setAttribute("key", key);
+        triles_elem.appendChild(entry_elem);
+
+        auto trile_elem = document.createElement("Trile");
+        trile_elem.setAttribute("name", numbered("trile_", key));
+        entry_elem.appendChild(trile_elem);
+
+        auto geometry_elem = document.createElement("Geometry");
+        trile_elem.appendChild(geometry_elem);
+
+        auto primitives_elem = document.createElement("ShaderInstancedIndexedPrimitives");
+        geometry_elem.appendChild(primitives_elem);
+
+        // full blocks and slabs of four heights, so neighbors cover each other only partly
+        const auto height = 0.25f * float(1 + key % 4);
+
+        appendBox(primitives_elem, {-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f + height, 0.5f}, 1);
+    }
+
+    return document;
+}
+
+QDomDocument CorpusGenerator::artObjectDocument(const int& artObject)
+{
+    const auto name = numbered("ao_", artObject);
+
+    auto size = std::uniform_int_distribution<int>(1, 4);
+    const auto extent = Vec3{float(size(m_Random)), float(size(m_Random)), float(size(m_Random))};
+
+    QDomDocument document;
+
+    auto art_object_elem = document.createElement("ArtObject");
+    art_object_elem.setAttribute("name", name);
+    document.appendChild(art_object_elem);
+
+    auto primitives_elem = document.createElement("ShaderInstancedIndexedPrimitives");
+    art_object_elem.appendChild(primitives_elem);
+
+    appendBox(primitives_elem, {-extent[0] / 2, -extent[1] / 2, -extent[2] / 2}, {extent[0] / 2, extent[1] / 2, extent[2] / 2}, m_Settings.m_ArtObjectDetail);
+
+    return document;
+}
+
+bool CorpusGenerator::writeTrileSet(const QString& path, const int& set)
+{
+    const auto name = numbered("set_", set);
+
+    if(!save(trileSetDocument(set), path + "/" + name + ".xml"))
+        return false;
+
+    return writeImage(path + "/" + name + ".png", m_Settings.m_TextureSize * 6, m_Settings.m_TextureSize, 1);
+}
+
+bool CorpusGenerator::writeArtObject(const QString& path, const int& artObject)
+{
+    const auto name = numbered("ao_", artObject);
+
+    if(!save(artObjectDocument(artObject), path + "/" + name + ".xml"))
+        return false;
+
+    return writeImage(path + "/" + name + ".png", m_Settings.m_TextureSize, m_Settings.m_TextureSize, 1);
+}
+
+bool CorpusGenerator::writePlaneTexture(const QString& path, const int& plane)
+{
+    const auto name = numbered("plane_", plane);
+
+    if(isAnimatedPlane(plane))
+        return writeAnimation(path, name);
+
+    return writeImage(path + "/" + name + ".png", m_Settings.m_TextureSize * 2, m_Settings.m_TextureSize, 1);
+}
+
+bool CorpusGenerator::writeCharacter(const QString& path, const int& character)
+{
+    const auto dir = QDir(path + "/" + numbered("npc_", character));
+
+    if(!dir.mkpath("."))
+        return false;
+
+    return writeAnimation(dir.path(), "Idle");
+}
+
+QDomDocument CorpusGenerator::levelDocument(const int& level)
+{
+    const auto name = numbered("level_", level);
+
+    QDomDocument document;
+
+    auto level_elem = document.createElement("Level");
+    level_elem.setAttribute("name", name);
+    level_elem.setAttribute("trileSetName", numbered("set_", level % m_Settings.m_NumTrileSets));
+    document.appendChild(level_elem);
+
+    // terrain of trile columns, the level grows sideways with the emplacement count
+    const auto num_emplacements = m_Settings.m_EmplacementsPerLevel;
+    const auto width = std::max(int(std::ceil(std::sqrt(float(num_emplacements) / 4.0f))), 1);
+
+    auto trile_id = std::uniform_int_distribution<int>(0, m_Settings.m_TrilesPerSet - 1);
+    auto orientation = std::uniform_int_distribution<int>(0, 3);
+    auto column_height = std::uniform_int_distribution<int>(1, 7);
+
+    auto triles_elem = document.createElement("Triles");
+    level_elem.appendChild(triles_elem);
+
+    auto max_height = 0;
+
+    for(int emplaced = 0, column = 0; emplaced < num_emplacements; column++)
+    {
+        const auto x = column % width;
+        const auto z = column / width % width;
+        const auto layer = column / (width * width);
+        const auto height = std::min(column_height(m_Random), num_emplacements - emplaced);
+
+        for(int h = 0; h < height; h++, emplaced++)
+        {
+            const auto y = layer * 8 + h;
+            const auto emplacement = Vec3{float(x), float(y), float(z)};
+
+            max_height = std::max(max_height, y + 1);
+
+            auto entry_elem = document.createElement("Entry");
+            triles_elem.appendChild(entry_elem);
+
+            auto emplacement_elem = document.createElement("TrileEmplacement");
+            emplacement_elem.setAttribute("x", x);
+            emplacement_elem.setAttribute("y", y);
+            emplacement_elem.setAttribute("z", z);
+            entry_elem.appendChild(emplacement_elem);
+
+            auto instance_elem = document.createElement("TrileInstance");
+            instance_elem.setAttribute("trileId", trile_id(m_Random));
+            instance_elem.setAttribute("orientation", orientation(m_Random));
+            entry_elem.appendChild(instance_elem);
+
+            appendVector3(instance_elem, "Position", {emplacement[0] + 0.5f, emplacement[1] + 0.5f, emplacement[2] + 0.5f});
+        }
+    }
+
+    // everything else stands on top of the terrain
+    auto ground = std::uniform_real_distribution<float>(0.0f, float(width));
+    auto yaw = std::uniform_int_distribution<int>(0, 3);
+
+    auto art_objects_elem = document.createElement("ArtObjects");
+    level_elem.appendChild(art_objects_elem);
+
+    auto art_object = std::uniform_int_distribution<int>(0, m_Settings.m_NumArtObjects - 1);
+
+    for(int i = 0; i < m_Settings.m_ArtObjectsPerLevel; i++)
+    {
+        auto entry_elem = document.createElement("Entry");
+        art_objects_elem.appendChild(entry_elem);
+
+        auto instance_elem = document.createElement("ArtObjectInstance");
+        instance_elem.setAttribute("name", numbered("ao_", art_object(m_Random)));
+        entry_elem.appendChild(instance_elem);
+
+        appendVector3(instance_elem, "Position", {ground(m_Random), float(max_height + 2), ground(m_Random)});
+        appendQuaternion(instance_elem, float(yaw(m_Random)) * std::numbers::pi_v<float> * 0.5f);
+        appendVector3(instance_elem, "Scale", {1.0f, 1.0f, 1.0f});
+    }
+
+    auto planes_elem = document.createElement("BackgroundPlanes");
+    level_elem.appendChild(planes_elem);
+
+    auto plane = std::uniform_int_distribution<int>(0, m_Settings.m_NumPlaneTextures - 1);
+
+    for(int i = 0; i < m_Settings.m_PlanesPerLevel; i++)
+    {
+        const auto texture = plane(m_Random);
+
+        auto entry_elem = document.createElement("Entry");
+        planes_elem.appendChild(entry_elem);
+
+        auto plane_elem = document.createElement("BackgroundPlane");
+        plane_elem.setAttribute("textureName", numbered("plane_", texture));
+        plane_elem.setAttribute("animated", isAnimatedPlane(texture) ? "true" : "false");
+        plane_elem.setAttribute("opacity", i % 3 == 0 ? "0.5" : "1");
+        plane_elem.setAttribute("doubleSided", i % 2 == 0 ? "true" : "false");
+        entry_elem.appendChild(plane_elem);
+
+        appendVector3(plane_elem, "Position", {ground(m_Random), float(max_height) * 0.5f, -1.0f});
+        appendQuaternion(plane_elem, 0.0f);
+        appendVector3(plane_elem, "Scale", {1.0f, 1.0f, 1.0f});
+    }
+
+    auto characters_elem = document.createElement("NonplayerCharacters");
+    level_elem.appendChild(characters_elem);
+
+    auto character = std::uniform_int_distribution<int>(0, m_Settings.m_NumCharacters - 1);
+
+    for(int i = 0; i < m_Settings.m_CharactersPerLevel; i++)
+    {
+        auto entry_elem = document.createElement("Entry");
+        characters_elem.appendChild(entry_elem);
+
+        auto npc_elem = document.createElement("NpcInstance");
+        npc_elem.setAttribute("name", numbered("npc_", character(m_Random)));
+        entry_elem.appendChild(npc_elem);
+
+        auto actions_elem = document.createElement("Actions");
+        npc_elem.appendChild(actions_elem);
+
+        auto action_elem = document.createElement("Action");
+        action_elem.setAttribute("key", "Idle");
+        actions_elem.appendChild(action_elem);
+
+        auto content_elem = document.createElement("NpcActionContent");
+        content_elem.setAttribute("animationName", "Idle");
+        action_elem.appendChild(content_elem);
+
+        appendVector3(npc_elem, "Position", {ground(m_Random), float(max_height), ground(m_Random)});
+    }
+
+    return document;
+}
+
+bool CorpusGenerator::writeLevel(const QString& path, const int& level)
+{
+    return save(levelDocument(level), path + "/" + numbered("level_", level) + ".xml");
+}
+
+bool CorpusGenerator::writeAnimation(const QString& path, const QString& name)
+{
+    const auto frame_size = m_Settings.m_TextureSize;
+    const auto num_frames = m_Settings.m_AnimationFrames;
+
+    // frames side by side in one sheet
+    QDomDocument document;
+
+    auto animation_elem = document.createElement("AnimatedTexturePC");
+    animation_elem.setAttribute("actualWidth", frame_size);
+    animation_elem.setAttribute("actualHeight", frame_size);
+    animation_elem.setAttribute("width", frame_size * num_frames);
+    animation_elem.setAttribute("height", frame_size);
+    document.appendChild(animation_elem);
+
+    auto frames_elem = document.createElement("Frames");
+    animation_elem.appendChild(frames_elem);
+
+    for(int i = 0; i < num_frames; i++)
+    {
+        auto frame_elem = document.createElement("FramePC");
+        frame_elem.setAttribute("duration", 1000000);
+        frames_elem.appendChild(frame_elem);
+
+        auto rectangle_elem = document.createElement("Rectangle");
+        rectangle_elem.setAttribute("x", i * frame_size);
+        rectangle_elem.setAttribute("y", 0);
+        rectangle_elem.setAttribute("w", frame_size);
+        rectangle_elem.setAttribute("h", frame_size);
+        frame_elem.appendChild(rectangle_elem);
+    }
+
+    if(!save(document, path + "/" + name + ".xml"))
+        return false;
+
+    return writeImage(path + "/" + name + ".ani.png", frame_size * num_frames, frame_size, num_frames);
+}
+
+bool CorpusGenerator::writeImage(const QString& file, const int& width, const int& height, const int& frames)
+{
+    auto image = QImage(width, height, QImage::Format::Format_ARGB32);
+
+    auto channel = std::uniform_int_distribution<int>(0, 255);
+    const auto frame_width = width / std::max(frames, 1);
+
+    // a checker board per frame with a cut out border, so alpha classification has work to do
+    for(int y = 0; y < height; y++)
+    {
+        auto line = reinterpret_cast<QRgb*>(image.scanLine(y));
+
+        for(int x = 0; x < width; x++)
+        {
+            const auto frame = x / frame_width;
+            const auto local_x = x % frame_width;
+            const auto border = local_x == 0 || y == 0 || local_x == frame_width - 1 || y == height - 1;
+            const auto checker = ((local_x / 8) + (y / 8) + frame) % 2 == 0;
+
+            line[x] = border ? qRgba(0, 0, 0, 0) : (checker ? qRgb(channel(m_Random), 128, 64) : qRgb(64, 128, channel(m_Random)));
+        }
+    }
+
+    return image.save(file, "PNG");
+}
+
+void CorpusGenerator::appendBox(QDomElement& primitives, const Vec3& min, const Vec3& max, const int& detail)
+{
+    auto document = primitives.ownerDocument();
+
+    auto vertices_elem = document.createElement("Vertices");
+    auto indices_elem = document.createElement("Indices");
+
+    primitives.appendChild(vertices_elem);
+    primitives.appendChild(indices_elem);
+
+    auto num_vertices = 0;
+
+    // sides 0 to 2 face -x, -y, -z, sides 3 to 5 face +x, +y, +z
+    for(int side = 0; side < 6; side++)
+    {
+        const auto axis = side % 3;
+        const auto positive = side >= 3;
+
+        // u x v points out of the box
+        const auto u = positive ? (axis + 1) % 3 : (axis + 2) % 3;
+        const auto v = positive ? (axis + 2) % 3 : (axis + 1) % 3;
+
+        for(int j = 0; j <= detail; j++)
+        {
+            for(int i = 0; i <= detail; i++)
+            {
+                const auto s = float(i) / float(detail);
+                const auto t = float(j) / float(detail);
+
+                auto position = Vec3();
+
+                position[axis] = positive ? max[axis] : min[axis];
+                position[u] = min[u] + (max[u] - min[u]) * s;
+                position[v] = min[v] + (max[v] - min[v]) * t;
+
+                auto vertex_elem = document.createElement("VertexPositionNormalTextureInstance");
+                vertices_elem.appendChild(vertex_elem);
+
+                appendVector3(vertex_elem, "Position", position);
+
+                auto normal_elem = document.createElement("Normal");
+                normal_elem.appendChild(document.createTextNode(QString::number(side)));
+                vertex_elem.appendChild(normal_elem);
+
+                auto texture_coord_elem = document.createElement("TextureCoord");
+                vertex_elem.appendChild(texture_coord_elem);
+
+                auto vector2_elem = document.createElement("Vector2");
+                vector2_elem.setAttribute("x", QString::number(s / 6.0f));
+                vector2_elem.setAttribute("y", QString::number(t));
+                texture_coord_elem.appendChild(vector2_elem);
+            }
+        }
+
+        for(int j = 0; j < detail; j++)
+        {
+            for(int i = 0; i < detail; i++)
+            {
+                const auto i0 = num_vertices + j * (detail + 1) + i;
+                const auto i1 = i0 + 1;
+                const auto i2 = i0 + detail + 1;
+                const auto i3 = i2 + 1;
+
+                for(const auto& index : {i0, i1, i3, i0, i3, i2})
+                {
+                    auto index_elem = document.createElement("Index");
+                    index_elem.appendChild(document.createTextNode(QString::number(index)));
+                    indices_elem.appendChild(index_elem);
+                }
+            }
+        }
+
+        num_vertices += (detail + 1) * (detail + 1);
+    }
+}
+
+void CorpusGenerator::appendVector3(QDomElement& parent, const QString& name, const Vec3& value)
+{
+    auto document = parent.ownerDocument();
+
+    auto elem = document.createElement(name);
+    parent.appendChild(elem);
+
+    auto vector3_elem = document.createElement("Vector3");
+    vector3_elem.setAttribute("x", QString::number(value[0]));
+    vector3_elem.setAttribute("y", QString::number(value[1]));
+    vector3_elem.setAttribute("z", QString::number(value[2]));
+    elem.appendChild(vector3_elem);
+}
+
+void CorpusGenerator::appendQuaternion(QDomElement& parent, const float& yaw)
+{
+    auto document = parent.ownerDocument();
+
+    auto elem = document.createElement("Rotation");
+    parent.appendChild(elem);
+
+    // rotation around the y axis
+    auto quaternion_elem = document.createElement("Quaternion");
+    quaternion_elem.setAttribute("x", "0");
+    quaternion_elem.setAttribute("y", QString::number(std::sin(yaw * 0.5f)));
+    quaternion_elem.setAttribute("z", "0");
+    quaternion_elem.setAttribute("w", QString::number(std::cos(yaw * 0.5f)));
+    elem.appendChild(quaternion_elem);
+}
+
+bool CorpusGenerator::save(const QDomDocument& document, const QString& file)
+{
+    QFile xml_file(file);
+
+    if(!xml_file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return false;
+
+    xml_file.write(document.toByteArray(2));
+    xml_file.close();
+
+    return true;
+}
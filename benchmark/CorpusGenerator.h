@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QString>
+
+#include <QtXml/QDomDocument>
+
+#include <array>
+#include <optional>
+#include <random>
+
+// scale of a synthetic content tree, every count is per run unless it says otherwise
+struct CorpusSettings
+{
+    int m_NumLevels = 4;
+    int m_NumTrileSets = 2;
+    int m_TrilesPerSet = 64;
+    int m_EmplacementsPerLevel = 4096;
+
+    int m_NumArtObjects = 16;
+    int m_ArtObjectsPerLevel = 32;
+
+    // quads along every edge of an art object face
+    int m_ArtObjectDetail = 4;
+
+    int m_NumPlaneTextures = 8;
+    int m_PlanesPerLevel = 8;
+
+    int m_NumCharacters = 4;
+    int m_CharactersPerLevel = 2;
+
+    int m_AnimationFrames = 8;
+    int m_TextureSize = 64;
+
+    unsigned int m_Seed = 1;
+};
+
+struct CorpusStats
+{
+    size_t m_Levels = 0;
+    size_t m_Emplacements = 0;
+    size_t m_Files = 0;
+    size_t m_Bytes = 0;
+};
+
+// writes levels, trile sets, art objects and plane and character textures in the layout the exporter reads
+class CorpusGenerator
+{
+    using Vec3 = std::array<float, 3>;
+
+public:
+    CorpusGenerator(const CorpusSettings& settings);
+
+    std::optional<CorpusStats> generate(const QString& path);
+
+    // file count, size and trile emplacements of an existing content tree
+    static CorpusStats measure(const QString& path);
+
+    // what the exporter wrote next to the content, size and cleanup between runs
+    static size_t exportSize(const QString& path);
+    static void clearExports(const QString& path);
+
+    static void addOptions(QCommandLineParser& parser);
+    static CorpusSettings settings(const QCommandLineParser& parser);
+
+    // the documents behind the files, for in memory fixtures
+    QDomDocument trileSetDocument(const int& set);
+    QDomDocument artObjectDocument(const int& artObject);
+    QDomDocument levelDocument(const int& level);
+
+private:
+    bool writeTrileSet(const QString& path, const int& set);
+    bool writeArtObject(const QString& path, const int& artObject);
+    bool writePlaneTexture(const QString& path, const int& plane);
+    bool writeCharacter(const QString& path, const int& character);
+    bool writeLevel(const QString& path, const int& level);
+
+    bool writeAnimation(const QString& path, const QString& name);
+    bool writeImage(const QString& file, const int& width, const int& height, const int& frames);
+
+    static void appendBox(QDomElement& primitives, const Vec3& min, const Vec3& max, const int& detail);
+    static void appendVector3(QDomElement& parent, const QString& name, const Vec3& value);
+    static void appendQuaternion(QDomElement& parent, const float& yaw);
+
+    static bool save(const QDomDocument& document, const QString& file);
+
+private:
+    CorpusSettings m_Settings;
+    std::mt19937 m_Random;
+};
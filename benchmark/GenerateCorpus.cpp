@@ -0,0 +1,37 @@
+#include "CorpusGenerator.h"
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QTextStream>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes a synthetic content tree with levels, trile sets, art objects and textures.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("path", "Output directory.");
+
+    CorpusGenerator::addOptions(parser);
+
+    parser.process(application);
+
+    QTextStream out(stdout);
+
+    if(parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    const auto stats = CorpusGenerator(CorpusGenerator::settings(parser)).generate(parser.positionalArguments().front());
+
+    if(!stats)
+    {
+        out << "corpus generation failed\n";
+        return 1;
+    }
+
+    out << qint64(stats->m_Levels) << " levels, " << qint64(stats->m_Emplacements) << " emplacements, " << qint64(stats->m_Files) << " files, "
+        << qint64(stats->m_Bytes) << " bytes\n";
+
+    return 0;
+}
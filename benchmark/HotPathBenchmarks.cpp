@@ -0,0 +1,200 @@
+#include "CorpusGenerator.h"
+#include "MicroBenchmark.h"
+
+#include "parser/GeometryParser.h"
+#include "parser/LevelParser.h"
+#include "parser/TextureParser.h"
+
+#include "texture/ImageCache.h"
+
+#include "writer/Writer.h"
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+    // expose the protected hot paths of the parsers and the obj writer
+    class BenchmarkGeometryParser : public GeometryParser
+    {
+    public:
+        using GeometryParser::parseIndices;
+        using GeometryParser::parseVertices;
+    };
+
+    class BenchmarkLevelParser : public LevelParser
+    {
+    public:
+        using LevelParser::readTrileEmplacements;
+    };
+
+    class BenchmarkWriter : public Writer
+    {
+    public:
+        using Writer::addGeometry;
+
+        BenchmarkWriter(const QString& path, const QString& saveName) : Writer(path)
+        {
+            m_SaveName = saveName;
+        }
+    };
+
+    // fixtures go through text once so they look exactly like parsed files
+    QDomDocument reparse(const QDomDocument& document)
+    {
+        QDomDocument result;
+        result.setContent(document.toByteArray(2));
+
+        return result;
+    }
+
+    // registers every hot path on fixtures built from the synthetic corpus
+    bool addHotPaths(MicroBenchmark& benchmark, const QString& path)
+    {
+        auto settings = CorpusSettings();
+
+        settings.m_NumLevels = 0;
+        settings.m_NumTrileSets = 1;
+        settings.m_NumArtObjects = 1;
+        settings.m_ArtObjectDetail = 16;
+        settings.m_NumPlaneTextures = 2;
+        settings.m_NumCharacters = 1;
+        settings.m_EmplacementsPerLevel = 16384;
+        settings.m_TextureSize = 256;
+
+        // textures have to be files, geometry and levels stay in memory
+        auto generator = CorpusGenerator(settings);
+
+        if(!generator.generate(path))
+            return false;
+
+        const auto art_object_document = reparse(generator.artObjectDocument(0));
+        const auto primitives_elem = art_object_document.firstChildElement("ArtObject").firstChildElement("ShaderInstancedIndexedPrimitives");
+
+        benchmark.add("GeometryParser::parseVertices", [art_object_document, primitives_elem]() -> size_t {
+            const auto vertices = BenchmarkGeometryParser().parseVertices(primitives_elem.firstChildElement("Vertices"));
+
+            return vertices ? vertices->size() : 0;
+        });
+
+        benchmark.add("GeometryParser::parseIndices", [art_object_document, primitives_elem]() -> size_t {
+            const auto indices = BenchmarkGeometryParser().parseIndices(primitives_elem.firstChildElement("Indices"));
+
+            return indices ? indices->size() : 0;
+        });
+
+        const auto level_document = reparse(generator.levelDocument(0));
+        const auto level_elem = level_document.firstChildElement("Level");
+
+        benchmark.add("LevelParser::readTrileEmplacements", [level_document, level_elem]() -> size_t {
+            const auto emplacements = BenchmarkLevelParser().readTrileEmplacements(level_elem);
+
+            return emplacements ? emplacements->size() : 0;
+        });
+
+        // the image cache is emptied every iteration, otherwise only the first one decodes
+        const auto planes_path = path + "/background planes";
+
+        benchmark.add("TextureParser::parse/static", [planes_path]() -> size_t {
+            ImageCache::clear();
+
+            const auto texture = TextureParser().parse(planes_path, "plane_000", false);
+
+            return texture ? size_t(texture->m_Width) * texture->m_Height : 0;
+        });
+
+        benchmark.add("TextureParser::parse/animated", [planes_path]() -> size_t {
+            ImageCache::clear();
+
+            const auto texture = TextureParser().parse(planes_path, "plane_001", true);
+
+            return texture ? size_t(texture->m_Width) * texture->m_Height * texture->m_TextureAnimationOffsets.size() : 0;
+        });
+
+        auto geometry = GeometryParser().parseGeometry(primitives_elem);
+
+        if(!geometry)
+            return false;
+
+        geometry->m_Name = "ao_000";
+        geometry->m_Texture.m_TextureName = "ao_000.png";
+        geometry->m_Texture.m_TextureOrgFile = path + "/art objects/ao_000.png";
+
+        const auto writer_path = path + "/writer";
+
+        // a fresh scene per iteration, adding to one scene grows its mesh array every time
+        benchmark.add("Writer::addGeometry", [art_object = *geometry, writer_path]() -> size_t {
+            BenchmarkWriter writer(writer_path, art_object.m_Name);
+
+            return writer.addGeometry(art_object) ? art_object.m_Vertices.size() : 0;
+        });
+
+        // save leaves the scene alone, so one scene is written over and over
+        const auto save_writer = std::make_shared<BenchmarkWriter>(writer_path, geometry->m_Name);
+
+        if(!save_writer->addGeometry(*geometry))
+            return false;
+
+        benchmark.add("Writer::save", [save_writer, num_vertices = geometry->m_Vertices.size()]() -> size_t {
+            save_writer->save();
+
+            return num_vertices;
+        });
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times parser and writer hot paths on in memory fixtures, reports ns and allocations per element.");
+    parser.addHelpOption();
+
+    const auto filter_option = QCommandLineOption("filter", "Only run benchmarks whose name matches the regular expression.", "regex", ".*");
+    const auto time_option = QCommandLineOption("min-time", "Minimum run time per benchmark in seconds.", "seconds", "0.5");
+    const auto json_option = QCommandLineOption("json", "Also write the results as json.", "file");
+
+    parser.addOption(filter_option);
+    parser.addOption(time_option);
+    parser.addOption(json_option);
+
+    parser.process(application);
+
+    QTextStream out(stdout);
+    QTemporaryDir fixture_dir;
+
+    auto benchmark = MicroBenchmark(std::max(parser.value(time_option).toDouble(), 0.01));
+
+    if(!fixture_dir.isValid() || !addHotPaths(benchmark, fixture_dir.path()))
+    {
+        out << "fixture generation failed\n";
+        return 1;
+    }
+
+    const auto results = benchmark.run(QRegularExpression(parser.value(filter_option)));
+
+    MicroBenchmark::print(results, out);
+
+    if(!parser.isSet(json_option))
+        return 0;
+
+    QFile json_file(parser.value(json_option));
+
+    if(!json_file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return 1;
+
+    json_file.write(QJsonDocument(QJsonObject{{"benchmarks", MicroBenchmark::toJson(results)}}).toJson(QJsonDocument::JsonFormat::Indented));
+    json_file.close();
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "MicroBenchmark.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonValue>
+
+#include <atomic>
+#include <cstdlib>
+
+namespace
+{
+    std::atomic<size_t> allocation_count = 0;
+}
+
+#ifdef __GLIBC__
+// counting replacements of the c allocation functions, they apply to the whole benchmark executable and every library it loads,
+// operator new and the storage of qt containers both end up here
+extern "C"
+{
+    void* __libc_malloc(size_t size) noexcept;
+    void* __libc_calloc(size_t count, size_t size) noexcept;
+    void* __libc_realloc(void* pointer, size_t size) noexcept;
+    void __libc_free(void* pointer) noexcept;
+
+    void* malloc(size_t size) noexcept
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+        return __libc_calloc(count, size);
+    }
+
+    // growing a container in place is as much an allocation as a new block
+    void* realloc(void* pointer, size_t size) noexcept
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+        return __libc_realloc(pointer, size);
+    }
+
+    void free(void* pointer) noexcept
+    {
+        __libc_free(pointer);
+    }
+}
+#endif
+
+double MicroBenchmark::Result::nsPerElement() const
+{
+    return m_Elements != 0 ? m_Seconds * 1e9 / double(m_Elements) : 0.0;
+}
+
+double MicroBenchmark::Result::allocationsPerElement() const
+{
+    return m_Elements != 0 ? double(m_Allocations) / double(m_Elements) : 0.0;
+}
+
+MicroBenchmark::MicroBenchmark(const double& minSeconds) : m_MinSeconds{minSeconds}, m_Cases{}
+{
+}
+
+void MicroBenchmark::add(const QString& name, const Function& function)
+{
+    m_Cases.push_back({name, function});
+}
+
+MicroBenchmark::Results MicroBenchmark::run(const QRegularExpression& filter) const
+{
+    Results results;
+
+    for(const auto& benchmark_case : m_Cases)
+    {
+        if(!filter.match(benchmark_case.first).hasMatch())
+            continue;
+
+        const auto& function = benchmark_case.second;
+
+        // one untimed iteration warms caches and lazy statics
+        function();
+
+        auto result = Result();
+        result.m_Name = benchmark_case.first;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        const auto first_allocation = allocations();
+
+        while(double(timer.nsecsElapsed()) * 1e-9 < m_MinSeconds)
+        {
+            result.m_Elements += function();
+            result.m_Iterations++;
+        }
+
+        result.m_Seconds = double(timer.nsecsElapsed()) * 1e-9;
+        result.m_Allocations = allocations() - first_allocation;
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+void MicroBenchmark::print(const Results& results, QTextStream& out)
+{
+    out << QString("benchmark").leftJustified(40) << QString("iterations").rightJustified(12) << QString("ns/element").rightJustified(14)
+        << QString("allocs/element").rightJustified(16) << "\n";
+
+    for(const auto& result : results)
+    {
+        const auto allocations = countsAllocations() ? QString::number(result.allocationsPerElement(), 'f', 3) : QString("-");
+
+        out << result.m_Name.leftJustified(40) << QString::number(result.m_Iterations).rightJustified(12)
+            << QString::number(result.nsPerElement(), 'f', 2).rightJustified(14) << allocations.rightJustified(16) << "\n";
+    }
+
+    out.flush();
+}
+
+QJsonArray MicroBenchmark::toJson(const Results& results)
+{
+    auto result = QJsonArray();
+
+    for(const auto& r : results)
+    {
+        result.append(QJsonObject{{"name", r.m_Name},
+                                  {"iterations", qint64(r.m_Iterations)},
+                                  {"elements", qint64(r.m_Elements)},
+                                  {"nsPerElement", r.nsPerElement()},
+                                  {"allocationsPerElement", countsAllocations() ? QJsonValue(r.allocationsPerElement()) : QJsonValue()}});
+    }
+
+    return result;
+}
+
+size_t MicroBenchmark::allocations()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+bool MicroBenchmark::countsAllocations()
+{
+#ifdef __GLIBC__
+    return true;
+#else
+    return false;
+#endif
+}
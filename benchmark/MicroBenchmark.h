@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QString>
+#include <QtCore/QTextStream>
+
+#include <functional>
+#include <vector>
+
+// google benchmark style runner, every case repeats until it ran for the minimum time
+class MicroBenchmark
+{
+public:
+    // one call is one iteration, it returns how many elements it processed
+    using Function = std::function<size_t()>;
+
+    struct Result
+    {
+        QString m_Name = {};
+        size_t m_Iterations = 0;
+        size_t m_Elements = 0;
+        size_t m_Allocations = 0;
+        double m_Seconds = 0.0;
+
+        double nsPerElement() const;
+        double allocationsPerElement() const;
+    };
+
+    using Results = std::vector<Result>;
+
+private:
+    using Case = std::pair<QString, Function>;
+    using Cases = std::vector<Case>;
+
+public:
+    MicroBenchmark(const double& minSeconds);
+
+    void add(const QString& name, const Function& function);
+
+    Results run(const QRegularExpression& filter) const;
+
+    static void print(const Results& results, QTextStream& out);
+    static QJsonArray toJson(const Results& results);
+
+    // calls of malloc, calloc and realloc so far
+    static size_t allocations();
+
+    // only glibc lets the executable replace malloc, elsewhere allocations stay 0 and are reported as missing
+    static bool countsAllocations();
+
+private:
+    double m_MinSeconds;
+    Cases m_Cases;
+};
@@ -0,0 +1,349 @@
+#include "CorpusGenerator.h"
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QProcess>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// exports fixed size synthetic corpora and fails when time, peak memory or output size drift past the stored baselines
+namespace
+{
+    // ctest reports the gate as skipped instead of failed, see SKIP_RETURN_CODE in CMakeLists.txt
+    constexpr auto skip_return_code = 77;
+
+    struct Metrics
+    {
+        double m_Seconds = 0.0;
+        size_t m_PeakRss = 0;
+        size_t m_OutputBytes = 0;
+    };
+
+    struct Tolerances
+    {
+        double m_Seconds = 0.25;
+        double m_PeakRss = 0.2;
+        double m_OutputBytes = 0.02;
+    };
+
+    struct Case
+    {
+        QString m_Name;
+        CorpusSettings m_Settings;
+    };
+
+    // sizes are part of the baselines, changing them means recording new ones
+    std::vector<Case> cases()
+    {
+        auto trile_set = CorpusSettings();
+        trile_set.m_NumLevels = 0;
+        trile_set.m_NumTrileSets = 1;
+        trile_set.m_TrilesPerSet = 1024;
+        trile_set.m_NumArtObjects = 0;
+        trile_set.m_NumPlaneTextures = 0;
+        trile_set.m_NumCharacters = 0;
+
+        auto art_object = CorpusSettings();
+        art_object.m_NumLevels = 0;
+        art_object.m_NumTrileSets = 0;
+        art_object.m_NumArtObjects = 1;
+        art_object.m_ArtObjectDetail = 96;
+        art_object.m_NumPlaneTextures = 0;
+        art_object.m_NumCharacters = 0;
+        art_object.m_TextureSize = 1024;
+
+        auto large_level = CorpusSettings();
+        large_level.m_NumLevels = 1;
+        large_level.m_NumTrileSets = 1;
+        large_level.m_TrilesPerSet = 128;
+        large_level.m_EmplacementsPerLevel = 131072;
+        large_level.m_NumArtObjects = 16;
+        large_level.m_ArtObjectsPerLevel = 128;
+        large_level.m_NumPlaneTextures = 8;
+        large_level.m_PlanesPerLevel = 32;
+        large_level.m_NumCharacters = 4;
+        large_level.m_CharactersPerLevel = 8;
+
+        return {{"trile_set", trile_set}, {"art_object", art_object}, {"large_level", large_level}};
+    }
+
+    QJsonObject toJson(const Metrics& metrics)
+    {
+        return QJsonObject{{"seconds", metrics.m_Seconds}, {"peakRssBytes", qint64(metrics.m_PeakRss)}, {"outputBytes", qint64(metrics.m_OutputBytes)}};
+    }
+
+    Metrics metrics(const QJsonObject& json)
+    {
+        return Metrics{json["seconds"].toDouble(), size_t(json["peakRssBytes"].toDouble()), size_t(json["outputBytes"].toDouble())};
+    }
+
+    // peak resident memory of the finished child, the measuring process never runs more than one
+    size_t childPeakRss(void* handle)
+    {
+#ifdef _WIN32
+        auto counters = PROCESS_MEMORY_COUNTERS();
+
+        if(!handle || !GetProcessMemoryInfo(HANDLE(handle), &counters, sizeof(counters)))
+            return 0;
+
+        return size_t(counters.PeakWorkingSetSize);
+#else
+        Q_UNUSED(handle);
+
+        auto usage = rusage();
+
+        if(getrusage(RUSAGE_CHILDREN, &usage) != 0)
+            return 0;
+
+#ifdef __APPLE__
+        return size_t(usage.ru_maxrss);
+#else
+        return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    // one export, wall time and peak memory of the exporter process
+    std::optional<Metrics> runExport(const QString& exporter, const QString& corpus, const QStringList& arguments)
+    {
+        CorpusGenerator::clearExports(corpus);
+
+        auto environment = QProcessEnvironment::systemEnvironment();
+        environment.insert("QT_QPA_PLATFORM", "offscreen");
+
+        QProcess process;
+        process.setProgram(exporter);
+        process.setArguments(QStringList{"--input", corpus} + arguments);
+        process.setProcessEnvironment(environment);
+        process.setProcessChannelMode(QProcess::ProcessChannelMode::MergedChannels);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        process.start();
+
+        if(!process.waitForStarted(-1))
+            return {};
+
+        // the handle has to be open before the exporter exits, otherwise its counters are gone
+        void* handle = nullptr;
+#ifdef _WIN32
+        handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, DWORD(process.processId()));
+#endif
+
+        while(!process.waitForFinished(100))
+            process.readAllStandardOutput();
+
+        auto result = Metrics{double(timer.nsecsElapsed()) * 1e-9, childPeakRss(handle), 0};
+
+#ifdef _WIN32
+        if(handle)
+            CloseHandle(HANDLE(handle));
+#endif
+
+        if(process.exitStatus() != QProcess::ExitStatus::NormalExit || process.exitCode() != 0)
+            return {};
+
+        result.m_OutputBytes = CorpusGenerator::exportSize(corpus);
+
+        return result;
+    }
+
+    // every repeat runs in a fresh child of the gate, so the peak memory of the children is the one of that export alone
+    std::optional<Metrics> measureCase(const QString& exporter, const QString& corpus, const QStringList& arguments)
+    {
+        QProcess process;
+        process.setProgram(QCoreApplication::applicationFilePath());
+        process.setArguments(QStringList{"--exporter", exporter, "--measure", corpus, "--"} + arguments);
+        process.setProcessChannelMode(QProcess::ProcessChannelMode::ForwardedErrorChannel);
+
+        process.start();
+
+        if(!process.waitForFinished(-1) || process.exitStatus() != QProcess::ExitStatus::NormalExit || process.exitCode() != 0)
+            return {};
+
+        const auto json = QJsonDocument::fromJson(process.readAllStandardOutput()).object();
+
+        if(json.isEmpty())
+            return {};
+
+        return metrics(json);
+    }
+
+    QString percent(const double& value)
+    {
+        return (value >= 0.0 ? "+" : "") + QString::number(value * 100.0, 'f', 1) + "%";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Exports fixed size synthetic corpora and compares time, peak memory and output size with stored baselines.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("arguments", "Extra exporter arguments, pass them after --.", "[-- arguments...]");
+
+    const auto exporter_option = QCommandLineOption("exporter", "Path of the FezModelGenerator executable.", "path", FMG_EXPORTER);
+    const auto baselines_option = QCommandLineOption("baselines", "Baseline json with tolerances and one entry per case.", "file", FMG_PERF_BASELINES);
+    const auto update_option = QCommandLineOption("update-baselines", "Write the measured values as new baselines instead of comparing.");
+    const auto repeat_option = QCommandLineOption("repeat", "Runs per case, the fastest and smallest values are used.", "count", "3");
+    const auto measure_option = QCommandLineOption("measure", "Internal, export the given corpus once and print its metrics as json.", "path");
+
+    parser.addOption(exporter_option);
+    parser.addOption(baselines_option);
+    parser.addOption(update_option);
+    parser.addOption(repeat_option);
+    parser.addOption(measure_option);
+
+    parser.process(application);
+
+    QTextStream out(stdout);
+
+    if(parser.isSet(measure_option))
+    {
+        const auto metrics = runExport(parser.value(exporter_option), parser.value(measure_option), parser.positionalArguments());
+
+        if(!metrics)
+            return 1;
+
+        out << QJsonDocument(toJson(*metrics)).toJson(QJsonDocument::JsonFormat::Compact);
+
+        return 0;
+    }
+
+    // baselines
+    auto tolerances = Tolerances();
+    auto baselines = QJsonObject();
+
+    QFile baselines_file(parser.value(baselines_option));
+
+    if(baselines_file.open(QIODevice::OpenModeFlag::ReadOnly))
+    {
+        const auto json = QJsonDocument::fromJson(baselines_file.readAll()).object();
+        const auto json_tolerances = json["tolerances"].toObject();
+
+        tolerances.m_Seconds = json_tolerances["seconds"].toDouble(tolerances.m_Seconds);
+        tolerances.m_PeakRss = json_tolerances["peakRssBytes"].toDouble(tolerances.m_PeakRss);
+        tolerances.m_OutputBytes = json_tolerances["outputBytes"].toDouble(tolerances.m_OutputBytes);
+
+        baselines = json["cases"].toObject();
+        baselines_file.close();
+    }
+    else if(!parser.isSet(update_option))
+    {
+        out << "no baselines in " << parser.value(baselines_option) << ", record them with --update-baselines\n";
+        return skip_return_code;
+    }
+
+    // measure
+    const auto repeats = std::max(parser.value(repeat_option).toInt(), 1);
+
+    auto measured = QJsonObject();
+    auto failed = false;
+
+    out << QString("case").leftJustified(14) << QString("metric").leftJustified(14) << QString("baseline").rightJustified(14) << QString("current").rightJustified(14)
+        << QString("change").rightJustified(10) << QString("limit").rightJustified(10) << "  status\n";
+
+    for(const auto& test_case : cases())
+    {
+        QTemporaryDir corpus_dir;
+
+        if(!corpus_dir.isValid() || !CorpusGenerator(test_case.m_Settings).generate(corpus_dir.path()))
+        {
+            out << test_case.m_Name << ": corpus generation failed\n";
+            return 1;
+        }
+
+        auto current = Metrics{std::numeric_limits<double>::max(), std::numeric_limits<size_t>::max(), 0};
+
+        for(int i = 0; i < repeats; i++)
+        {
+            const auto run = measureCase(parser.value(exporter_option), corpus_dir.path(), parser.positionalArguments());
+
+            if(!run)
+            {
+                out << test_case.m_Name << ": export failed\n";
+                return 1;
+            }
+
+            current.m_Seconds = std::min(current.m_Seconds, run->m_Seconds);
+            current.m_PeakRss = std::min(current.m_PeakRss, run->m_PeakRss);
+            current.m_OutputBytes = run->m_OutputBytes;
+        }
+
+        measured[test_case.m_Name] = toJson(current);
+
+        if(parser.isSet(update_option))
+        {
+            out << test_case.m_Name.leftJustified(14) << QString::number(current.m_Seconds, 'f', 3) << " s, " << qint64(current.m_PeakRss) << " bytes peak, "
+                << qint64(current.m_OutputBytes) << " bytes written\n";
+            continue;
+        }
+
+        if(!baselines.contains(test_case.m_Name))
+        {
+            out << test_case.m_Name.leftJustified(14) << "no baseline  FAIL\n";
+            failed = true;
+            continue;
+        }
+
+        const auto baseline = metrics(baselines[test_case.m_Name].toObject());
+
+        // time and memory may only grow within their tolerance, output size may not move in either direction
+        const auto compare = [&](const QString& metric, const double& base, const double& value, const double& tolerance, const bool& bothWays, const int& precision) {
+            const auto change = base > 0.0 ? value / base - 1.0 : 0.0;
+            const auto exceeded = bothWays ? std::abs(change) > tolerance : change > tolerance;
+
+            out << test_case.m_Name.leftJustified(14) << metric.leftJustified(14) << QString::number(base, 'f', precision).rightJustified(14)
+                << QString::number(value, 'f', precision).rightJustified(14) << percent(change).rightJustified(10)
+                << ((bothWays ? "+/-" : "+") + QString::number(tolerance * 100.0, 'f', 0) + "%").rightJustified(10) << (exceeded ? "  FAIL\n" : "  ok\n");
+
+            failed |= exceeded;
+        };
+
+        compare("seconds", baseline.m_Seconds, current.m_Seconds, tolerances.m_Seconds, false, 3);
+        compare("peak rss", double(baseline.m_PeakRss), double(current.m_PeakRss), tolerances.m_PeakRss, false, 0);
+        compare("output bytes", double(baseline.m_OutputBytes), double(current.m_OutputBytes), tolerances.m_OutputBytes, true, 0);
+    }
+
+    if(!parser.isSet(update_option))
+    {
+        out << (failed ? "\nperformance regression, see FAIL rows above\n" : "\nall cases within tolerance\n");
+        return failed ? 1 : 0;
+    }
+
+    const auto report = QJsonObject{
+        {"tolerances", QJsonObject{{"seconds", tolerances.m_Seconds}, {"peakRssBytes", tolerances.m_PeakRss}, {"outputBytes", tolerances.m_OutputBytes}}},
+        {"cases", measured}};
+
+    if(!baselines_file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return 1;
+
+    baselines_file.write(QJsonDocument(report).toJson(QJsonDocument::JsonFormat::Indented));
+    baselines_file.close();
+
+    out << "baselines written to " << parser.value(baselines_option) << "\n";
+
+    return 0;
+}
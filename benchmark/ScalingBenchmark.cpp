@@ -0,0 +1,200 @@
+#include "CorpusGenerator.h"
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QProcess>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+
+// runs the whole exporter over a synthetic corpus at growing thread counts and reports how it scales
+namespace
+{
+    struct Run
+    {
+        int m_Threads = 0;
+        double m_Seconds = 0.0;
+        size_t m_OutputBytes = 0;
+    };
+
+    // wall time of one export, the exporter runs headless in its own process so no cache survives between runs
+    std::optional<double> runExport(const QString& exporter, const QString& corpus, const int& threads, const QStringList& arguments)
+    {
+        CorpusGenerator::clearExports(corpus);
+
+        auto environment = QProcessEnvironment::systemEnvironment();
+        environment.insert("QT_QPA_PLATFORM", "offscreen");
+
+        QProcess process;
+        process.setProgram(exporter);
+        process.setArguments(QStringList{"--input", corpus, "--threads", QString::number(threads)} + arguments);
+        process.setProcessEnvironment(environment);
+        process.setProcessChannelMode(QProcess::ProcessChannelMode::MergedChannels);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        process.start();
+
+        if(!process.waitForStarted(-1))
+            return {};
+
+        // the exporter logs a line per file, drain it so the pipe never blocks
+        while(!process.waitForFinished(100))
+            process.readAllStandardOutput();
+
+        const auto seconds = double(timer.nsecsElapsed()) * 1e-9;
+
+        if(process.exitStatus() != QProcess::ExitStatus::NormalExit || process.exitCode() != 0)
+            return {};
+
+        return seconds;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication application(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Exports a synthetic corpus at 1 to N threads and reports wall time, throughput and speedup.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("arguments", "Extra exporter arguments, pass them after --.", "[-- arguments...]");
+
+    const auto exporter_option = QCommandLineOption("exporter", "Path of the FezModelGenerator executable.", "path", FMG_EXPORTER);
+    const auto corpus_option = QCommandLineOption("corpus", "Existing content directory, a synthetic one is generated when not set.", "path");
+    const auto keep_option = QCommandLineOption("keep-corpus", "Generate the corpus into the given directory and keep it.", "path");
+    const auto threads_option = QCommandLineOption("max-threads", "Largest thread count, runs double from 1 up to it.", "count", QString::number(QThread::idealThreadCount()));
+    const auto repeat_option = QCommandLineOption("repeat", "Runs per thread count, the fastest one is reported.", "count", "3");
+    const auto json_option = QCommandLineOption("json", "Also write the results as json.", "file");
+
+    parser.addOption(exporter_option);
+    parser.addOption(corpus_option);
+    parser.addOption(keep_option);
+    parser.addOption(threads_option);
+    parser.addOption(repeat_option);
+    parser.addOption(json_option);
+
+    CorpusGenerator::addOptions(parser);
+
+    parser.process(application);
+
+    QTextStream out(stdout);
+
+    // corpus
+    QTemporaryDir temporary_dir;
+    auto corpus = parser.value(corpus_option);
+
+    if(corpus.isEmpty())
+    {
+        corpus = parser.isSet(keep_option) ? parser.value(keep_option) : temporary_dir.path();
+
+        out << "generating corpus in " << corpus << "\n";
+        out.flush();
+
+        if(!CorpusGenerator(CorpusGenerator::settings(parser)).generate(corpus))
+        {
+            out << "corpus generation failed\n";
+            return 1;
+        }
+    }
+
+    const auto stats = CorpusGenerator::measure(corpus);
+    const auto input_mb = double(stats.m_Bytes) / (1024.0 * 1024.0);
+
+    out << "corpus: " << qint64(stats.m_Levels) << " levels, " << qint64(stats.m_Emplacements) << " emplacements, " << qint64(stats.m_Files) << " files, "
+        << QString::number(input_mb, 'f', 2) << " MB\n";
+
+    // 1, 2, 4, ... and the maximum itself
+    const auto max_threads = std::max(parser.value(threads_option).toInt(), 1);
+    const auto repeats = std::max(parser.value(repeat_option).toInt(), 1);
+
+    auto thread_counts = std::vector<int>();
+
+    for(int threads = 1; threads < max_threads; threads *= 2)
+        thread_counts.push_back(threads);
+
+    thread_counts.push_back(max_threads);
+
+    auto runs = std::vector<Run>();
+
+    for(const auto& threads : thread_counts)
+    {
+        auto run = Run{threads, std::numeric_limits<double>::max(), 0};
+
+        for(int i = 0; i < repeats; i++)
+        {
+            const auto seconds = runExport(parser.value(exporter_option), corpus, threads, parser.positionalArguments());
+
+            if(!seconds)
+            {
+                out << "export with " << threads << " threads failed\n";
+                return 1;
+            }
+
+            run.m_Seconds = std::min(run.m_Seconds, *seconds);
+        }
+
+        run.m_OutputBytes = CorpusGenerator::exportSize(corpus);
+        runs.push_back(run);
+    }
+
+    CorpusGenerator::clearExports(corpus);
+
+    // report
+    const auto base_seconds = runs.front().m_Seconds;
+
+    out << "\n"
+        << QString("threads").rightJustified(8) << QString("seconds").rightJustified(10) << QString("empl/s").rightJustified(12) << QString("MB/s").rightJustified(10)
+        << QString("out MB").rightJustified(10) << QString("speedup").rightJustified(10) << QString("efficiency").rightJustified(12) << "\n";
+
+    auto json_runs = QJsonArray();
+
+    for(const auto& run : runs)
+    {
+        const auto emplacements_per_second = double(stats.m_Emplacements) / run.m_Seconds;
+        const auto mb_per_second = input_mb / run.m_Seconds;
+        const auto output_mb = double(run.m_OutputBytes) / (1024.0 * 1024.0);
+        const auto speedup = base_seconds / run.m_Seconds;
+        const auto efficiency = speedup / double(run.m_Threads);
+
+        out << QString::number(run.m_Threads).rightJustified(8) << QString::number(run.m_Seconds, 'f', 3).rightJustified(10)
+            << QString::number(emplacements_per_second, 'f', 0).rightJustified(12) << QString::number(mb_per_second, 'f', 2).rightJustified(10)
+            << QString::number(output_mb, 'f', 2).rightJustified(10) << QString::number(speedup, 'f', 2).rightJustified(10)
+            << QString::number(efficiency * 100.0, 'f', 0).rightJustified(11) << "%\n";
+
+        json_runs.append(QJsonObject{{"threads", run.m_Threads},
+                                     {"seconds", run.m_Seconds},
+                                     {"emplacementsPerSecond", emplacements_per_second},
+                                     {"mbPerSecond", mb_per_second},
+                                     {"outputBytes", qint64(run.m_OutputBytes)},
+                                     {"speedup", speedup}});
+    }
+
+    if(!parser.isSet(json_option))
+        return 0;
+
+    const auto report = QJsonObject{{"levels", qint64(stats.m_Levels)},
+                                    {"emplacements", qint64(stats.m_Emplacements)},
+                                    {"inputBytes", qint64(stats.m_Bytes)},
+                                    {"runs", json_runs}};
+
+    QFile json_file(parser.value(json_option));
+
+    if(!json_file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return 1;
+
+    json_file.write(QJsonDocument(report).toJson(QJsonDocument::JsonFormat::Indented));
+    json_file.close();
+
+    return 0;
+}
@@ -4,109 +4,511 @@
 #include "parser/LevelParser.h"
 #include "parser/TrileSetParser.h"
 
-#include "writer/GeometryWriter.h"
-#include "writer/LevelWriter.h"
-
+#include "processor/FaceMerger.h"
+#include "processor/LevelAnalyzer.h"
+#include "processor/LevelBatcher.h"
+#include "processor/LevelChunker.h"
+#include "processor/LodGenerator.h"
+#include "processor/MeshDeduplicator.h"
+#include "processor/MeshOptimizer.h"
+#include "processor/TextureAtlasBuilder.h"
+#include "processor/TrileCuller.h"
+
+#include "scheduling/MemoryBudgetScheduler.h"
+#include "scheduling/Prefetcher.h"
+#include "scheduling/ShardPlanner.h"
+
+#include "profiling/CounterProfiler.h"
+#include "profiling/MemoryFootprint.h"
+#include "profiling/MemoryReport.h"
+#include "profiling/Trace.h"
+
+#include "texture/FlipbookExtractor.h"
+#include "texture/ImageCache.h"
+#include "texture/TextureTranscoder.h"
+
+#include "writer/ChunkIndexWriter.h"
+#include "writer/ExportBackend.h"
+#include "writer/LodIndexWriter.h"
+#include "writer/ShardManifest.h"
+#include "writer/TrileSetWriter.h"
+
+#include <QtCore/QCommandLineParser>
 #include <QtCore/QDirIterator>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QFutureSynchronizer>
+#include <QtCore/QThreadPool>
 
 #include <QtWidgets/QFileDialog>
 
+#include <QtConcurrent/QtConcurrentMap>
 #include <QtConcurrent/QtConcurrentRun>
 
+namespace
+{
+    QStringList xmlFiles(const QString& path)
+    {
+        auto xml_iter = QDirIterator(path, {"*.xml"}, QDir::Filter::Files | QDir::Filter::NoDotAndDotDot | QDir::Filter::NoSymLinks);
+
+        QStringList result;
+
+        while(xml_iter.hasNext())
+            result.push_back(xml_iter.next());
+
+        return result;
+    }
+
+    // art objects and trile sets open their xml and the png next to it
+    QStringList texturedFiles(const QString& file)
+    {
+        const auto info = QFileInfo(file);
+
+        return {file, info.absolutePath() + "/" + info.baseName() + ".png"};
+    }
+}
+
 void Application::onRun()
 {
-    const auto path = QFileDialog::getExistingDirectory(nullptr, "Export", QStandardPaths::writableLocation(QStandardPaths::StandardLocation::DesktopLocation));
-    
-    processArtObjects(path);
-    processTrileSets(path);
-    processLevels(path);
+    if(!parseArguments())
+    {
+        exit(1);
+        return;
+    }
+
+    if(m_Settings.m_NumThreads > 0)
+        QThreadPool::globalInstance()->setMaxThreadCount(m_Settings.m_NumThreads);
+
+    if(!m_Settings.m_TracePath.isEmpty())
+        Trace::start();
+
+    if(m_Settings.m_ProfileCounters)
+        CounterProfiler::start();
+
+    if(!m_Settings.m_MemoryReportPath.isEmpty())
+        MemoryReport::start();
+
+    // scripted runs pass the directory, interactive runs pick it
+    const auto path = !m_Settings.m_InputPath.isEmpty()
+                          ? m_Settings.m_InputPath
+                          : QFileDialog::getExistingDirectory(nullptr, "Export", QStandardPaths::writableLocation(QStandardPaths::StandardLocation::DesktopLocation));
+
+    if(path.isEmpty())
+    {
+        exit(1);
+        return;
+    }
+
+    if(m_Settings.m_MergeShards > 0)
+    {
+        exit(ShardManifest::merge(path, m_Settings.m_MergeShards) ? 0 : 1);
+        return;
+    }
+
+    QElapsedTimer run_timer;
+    run_timer.start();
+
+    auto art_object_files = xmlFiles(path + "/art objects");
+    auto trile_set_files = xmlFiles(path + "/trile sets");
+    auto level_files = xmlFiles(path + "/levels");
+
+    const auto shard = Shard{m_Settings.m_ShardIndex, m_Settings.m_ShardCount};
+    const auto is_sharded = shard.m_Count > 0;
+
+    if(is_sharded)
+    {
+        const auto assignment = ShardPlanner(shard).plan(art_object_files, trile_set_files, level_files);
+
+        art_object_files = assignment.m_ArtObjects;
+        trile_set_files = assignment.m_TrileSets;
+        level_files = assignment.m_Levels;
+
+        qDebug() << "Shard " << shard.m_Index << "/" << shard.m_Count << ": " << art_object_files.size() << " art objects, " << trile_set_files.size()
+                 << " trile sets, " << level_files.size() << " levels";
+    }
+
+    // decoded images are only shared inside a stage, the next one starts with an empty image cache
+    processArtObjects(path, art_object_files);
+    ImageCache::clear();
+
+    processTrileSets(path, trile_set_files);
+    ImageCache::clear();
+
+    processLevels(path, level_files);
+
+    // shards keep their dedupe report next to their manifest until the merge
+    if(m_Settings.m_DeduplicateMeshes)
+        MeshDeduplicator::writeReport(is_sharded ? ShardManifest::shardPath(path, shard) : path);
+
+    if(is_sharded && !ShardManifest::write(path, shard, double(run_timer.nsecsElapsed()) * 1e-9))
+        qDebug() << "Error: could not write the manifest of shard " << shard.m_Index << "/" << shard.m_Count;
+
+    if(!m_Settings.m_TracePath.isEmpty() && !Trace::write(m_Settings.m_TracePath))
+        qDebug() << "Error: could not write trace to " << m_Settings.m_TracePath;
+
+    if(m_Settings.m_ProfileCounters)
+        CounterProfiler::print();
+
+    if(!m_Settings.m_MemoryReportPath.isEmpty())
+    {
+        auto caches = LevelParser::cacheUsage();
+        caches.push_back(ImageCache::usage());
+
+        qDebug() << "Peak memory: " << MemoryReport::peakRss() / (1024 * 1024) << " MB";
+
+        if(!MemoryReport::write(m_Settings.m_MemoryReportPath, caches))
+            qDebug() << "Error: could not write memory report to " << m_Settings.m_MemoryReportPath;
+    }
 
     exit();
 }
 
-void Application::processArtObjects(const QString& path)
+bool Application::parseArguments()
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+
+    const auto formats_option = QCommandLineOption("formats", "Comma separated list of output formats: obj, glb, stats.", "formats", "obj");
+    const auto quantize_option = QCommandLineOption("quantize", "Quantize glb positions, normals and texture coordinates (KHR_mesh_quantization).");
+    const auto batch_option = QCommandLineOption("batch", "Bake level geometry into one merged mesh per material.");
+    const auto cull_option = QCommandLineOption("cull", "Remove trile faces that are covered by a neighboring trile.");
+    const auto merge_option = QCommandLineOption("merge-faces", "Merge coplanar trile faces with continuous texture mapping into larger quads.");
+    const auto chunk_option = QCommandLineOption("chunk-size", "Split levels into spatial chunks of the given size in triles, 0 disables chunking.", "size", "0");
+    const auto optimize_option = QCommandLineOption("optimize", "Weld vertices, drop degenerate triangles and reorder meshes for the vertex cache.");
+    const auto atlas_option = QCommandLineOption("atlas-size", "Pack background plane and character textures of a level into atlases of the given size, 0 disables atlases.", "size", "0");
+    const auto flipbook_option = QCommandLineOption("flipbooks", "Slice animated plane and character textures into numbered frames with a binary timing table.");
+    const auto compress_option = QCommandLineOption("compress-textures", "Write textures as dds, bc1 for opaque and bc3 for textures with alpha.");
+    const auto mipmaps_option = QCommandLineOption("mipmaps", "Add mipmaps to compressed textures.");
+    const auto lods_option = QCommandLineOption("lods", "Number of decimated lods (up to 4) per art object and level chunk, 0 disables lods.", "count", "0");
+    const auto dedupe_option = QCommandLineOption("dedupe", "Export identical triles and art objects once and point every reference at the kept copy.");
+    const auto input_option = QCommandLineOption("input", "Directory with the extracted game content, skips the directory dialog.", "path");
+    const auto threads_option = QCommandLineOption("threads", "Number of worker threads, 0 uses one per core.", "count", "0");
+    const auto prefetch_option = QCommandLineOption("prefetch", "Read the input files of upcoming jobs into the file cache, at most the given MB ahead of the workers, 0 disables it.", "mb", "0");
+    const auto budget_option = QCommandLineOption("memory-budget", "Start level jobs only while their estimated memory stays below the given MB, 0 starts all at once.", "mb", "0");
+    const auto shard_option = QCommandLineOption("shard", "Export only part i of N (1 <= i <= N), levels stay with their trile set. Writes shards/<i>_of_<N>/manifest.json.", "i/N");
+    const auto merge_shards_option = QCommandLineOption("merge-shards", "Combine the manifests and dedupe reports of N shards in the input directory instead of exporting.", "N", "0");
+    const auto trace_option = QCommandLineOption("trace", "Write per stage timings as chrome trace events (chrome://tracing, ui.perfetto.dev).", "file");
+    const auto counters_option = QCommandLineOption("counters", "Count cycles, instructions, cache and branch misses per stage with perf_event_open (Linux) and print a table.");
+    const auto memory_option = QCommandLineOption("memory-report", "Write estimated cache and level footprints, allocations per stage (FMG_COUNT_ALLOCATIONS builds) and peak memory as json.", "file");
+
+    parser.addOption(formats_option);
+    parser.addOption(quantize_option);
+    parser.addOption(batch_option);
+    parser.addOption(cull_option);
+    parser.addOption(merge_option);
+    parser.addOption(chunk_option);
+    parser.addOption(optimize_option);
+    parser.addOption(atlas_option);
+    parser.addOption(flipbook_option);
+    parser.addOption(compress_option);
+    parser.addOption(mipmaps_option);
+    parser.addOption(lods_option);
+    parser.addOption(dedupe_option);
+    parser.addOption(input_option);
+    parser.addOption(threads_option);
+    parser.addOption(prefetch_option);
+    parser.addOption(budget_option);
+    parser.addOption(shard_option);
+    parser.addOption(merge_shards_option);
+    parser.addOption(trace_option);
+    parser.addOption(counters_option);
+    parser.addOption(memory_option);
+
+    parser.process(arguments());
+
+    const auto formats = parser.value(formats_option).split(',', Qt::SplitBehaviorFlags::SkipEmptyParts);
+
+    m_Settings.m_WriteObj = formats.contains("obj");
+    m_Settings.m_WriteGlb = formats.contains("glb");
+    m_Settings.m_WriteStats = formats.contains("stats");
+    m_Settings.m_QuantizeGlb = parser.isSet(quantize_option);
+    m_Settings.m_BatchLevels = parser.isSet(batch_option);
+    m_Settings.m_CullHiddenFaces = parser.isSet(cull_option);
+    m_Settings.m_MergeCoplanarFaces = parser.isSet(merge_option);
+    m_Settings.m_ChunkSize = std::max(parser.value(chunk_option).toInt(), 0);
+    m_Settings.m_OptimizeMeshes = parser.isSet(optimize_option);
+    m_Settings.m_AtlasSize = std::max(parser.value(atlas_option).toInt(), 0);
+    m_Settings.m_ExtractFlipbooks = parser.isSet(flipbook_option);
+    m_Settings.m_CompressTextures = parser.isSet(compress_option);
+    m_Settings.m_Mipmaps = parser.isSet(mipmaps_option);
+    m_Settings.m_NumLods = std::clamp(parser.value(lods_option).toInt(), 0, 4);
+    m_Settings.m_DeduplicateMeshes = parser.isSet(dedupe_option);
+    m_Settings.m_InputPath = parser.value(input_option);
+    m_Settings.m_NumThreads = std::max(parser.value(threads_option).toInt(), 0);
+    m_Settings.m_PrefetchWindow = std::max(parser.value(prefetch_option).toInt(), 0);
+    m_Settings.m_MemoryBudget = std::max(parser.value(budget_option).toInt(), 0);
+    m_Settings.m_TracePath = parser.value(trace_option);
+    m_Settings.m_ProfileCounters = parser.isSet(counters_option);
+    m_Settings.m_MemoryReportPath = parser.value(memory_option);
+    m_Settings.m_MergeShards = std::max(parser.value(merge_shards_option).toInt(), 0);
+
+    if(!parser.isSet(shard_option))
+        return true;
+
+    const auto shard = ShardPlanner::parse(parser.value(shard_option));
+
+    if(!shard)
+    {
+        qDebug() << "Error: --shard expects i/N with 1 <= i <= N, got " << parser.value(shard_option);
+        return false;
+    }
+
+    m_Settings.m_ShardIndex = shard->m_Index;
+    m_Settings.m_ShardCount = shard->m_Count;
+
+    return true;
+}
+
+void Application::processArtObjects(const QString& path, const QStringList& files)
 {
-    auto ao_xml_iter = QDirIterator(path + "/art objects", {"*.xml"}, QDir::Filter::Files | QDir::Filter::NoDotAndDotDot | QDir::Filter::NoSymLinks);
+    auto prefetcher = Prefetcher(size_t(m_Settings.m_PrefetchWindow) * 1024 * 1024);
+    prefetcher.start(files, texturedFiles);
 
-    QStringList art_objects_files;
+    const auto parse_function = [&prefetcher](const QString& file) {
+        prefetcher.started();
 
-    while(ao_xml_iter.hasNext())
-        art_objects_files.push_back(ao_xml_iter.next());
+        const auto name = QFileInfo(file).baseName();
 
-    const auto export_function = [](const auto& file, const auto& path) -> void{
-        ArtObjectParser parser;
-        const auto result = parser.parse(file);
+        TraceSpan span("parse art object", name);
+        ShardManifest::Timer timer("artObjects", name);
 
-        if(!result)
+        return ArtObjectParser().parse(file);
+    };
+
+    const auto export_function = [settings = m_Settings, backends = ExportBackend::create(m_Settings)](auto result, const auto& path) -> void {
+        TraceSpan span("export art object", result.m_Name);
+        ShardManifest::Timer timer("artObjects", result.m_Name);
+
+        if(settings.m_OptimizeMeshes)
+            result = MeshOptimizer().optimize(result);
+
+        if(settings.m_CompressTextures)
+            result = TextureTranscoder(path + "/ao_export", settings.m_Mipmaps).transcode(result);
+
+        qDebug() << "Write: " << result.m_Name;
+
+        for(const auto& backend : backends)
+            backend->writeGeometry(path + "/ao_export", result);
+
+        if(settings.m_NumLods == 0)
             return;
 
-        qDebug() << "Write: " << result->m_Name;
+        const auto lods = LodGenerator(settings.m_NumLods).generate(result.m_Name, {result});
+
+        for(const auto& lod : lods)
+        {
+            for(const auto& geometry : lod.m_Geometries)
+                for(const auto& backend : backends)
+                    backend->writeGeometry(path + "/ao_export", geometry);
+        }
 
-        GeometryWriter(path + "/ao_export").writeObj(*result);
+        LodIndexWriter(path + "/ao_export").writeIndex(result.m_Name, result.m_Indices.size() / 3, lods, settings.extensions());
     };
 
     auto waiter = QFutureSynchronizer<void>();
 
-    for(const auto& file : art_objects_files)
-        waiter.addFuture(QtConcurrent::run(export_function, file, path));
+    // without dedupe every art object is parsed and written by one job, it is dropped right after
+    if(!m_Settings.m_DeduplicateMeshes)
+    {
+        for(const auto& file : files)
+        {
+            waiter.addFuture(QtConcurrent::run([&parse_function, &export_function, &path, file]() {
+                auto result = parse_function(file);
+
+                if(result)
+                    export_function(std::move(*result), path);
+            }));
+        }
+
+        waiter.waitForFinished();
+        return;
+    }
+
+    // dedupe parses everything up front so copies of one art object are found before anything is written
+    auto art_objects = Level::ArtObjectGeometries();
+    QMutex art_objects_mutex;
+
+    QtConcurrent::blockingMap(files, [&parse_function, &art_objects, &art_objects_mutex](const QString& file) {
+        auto result = parse_function(file);
+
+        if(!result)
+            return;
+
+        QMutexLocker locker(&art_objects_mutex);
+        art_objects.insert({result->m_Name, std::move(*result)});
+    });
+
+    MeshDeduplicator("art objects").dedupe(art_objects);
+
+    for(const auto& art_object : art_objects)
+        waiter.addFuture(QtConcurrent::run(export_function, art_object.second, path));
 
     waiter.waitForFinished();
 }
 
-void Application::processTrileSets(const QString& path)
+void Application::processTrileSets(const QString& path, const QStringList& files)
 {
-    auto ts_xml_iter = QDirIterator(path + "/trile sets", {"*.xml"}, QDir::Filter::Files | QDir::Filter::NoDotAndDotDot | QDir::Filter::NoSymLinks);
+    auto prefetcher = Prefetcher(size_t(m_Settings.m_PrefetchWindow) * 1024 * 1024);
+    prefetcher.start(files, texturedFiles);
 
-    QStringList trile_set_files;
+    const auto export_function = [settings = m_Settings, backends = ExportBackend::create(m_Settings), &prefetcher](const auto& file, const auto& path) -> void {
+        prefetcher.started();
 
-    while(ts_xml_iter.hasNext())
-        trile_set_files.push_back(ts_xml_iter.next());
+        TraceSpan span("export trile set", QFileInfo(file).baseName());
+        ShardManifest::Timer timer("trileSets", QFileInfo(file).baseName());
 
-    const auto export_function = [](const auto& file, const auto& path) -> void {
         TrileSetParser parser;
-        const auto result = parser.parse(file);
+        auto result = parser.parse(file);
         const auto& set_name = parser.getSetName();
+        const auto out_path = path + "/ts_export/" + set_name;
+
+        // identical triles under different keys are written once, the manifest points the other keys at it
+        const auto aliases = settings.m_DeduplicateMeshes ? MeshDeduplicator("trile sets").dedupe(result, set_name) : TrileSetWriter::Aliases();
 
-        for(const auto& r : result)
+        for(auto& r : result)
         {
-            qDebug() << "Write: " << r.second.m_Name;
+            if(settings.m_OptimizeMeshes)
+                r.second = MeshOptimizer().optimize(r.second);
 
-            GeometryWriter(path + "/ts_export/" + set_name).writeObj(r.second);
+            if(settings.m_CompressTextures)
+                r.second = TextureTranscoder(out_path, settings.m_Mipmaps).transcode(r.second);
         }
+
+        qDebug() << "Write: " << set_name;
+
+        // the whole set goes into one file per format
+        for(const auto& backend : backends)
+            backend->writeTrileSet(out_path, set_name, result);
+
+        TrileSetWriter::writeManifest(out_path, set_name, result, settings.extensions(), aliases);
     };
 
     auto waiter = QFutureSynchronizer<void>();
 
-    for(const auto& file : trile_set_files)
+    for(const auto& file : files)
         waiter.addFuture(QtConcurrent::run(export_function, file, path));
 
     waiter.waitForFinished();
 }
 
-void Application::processLevels(const QString& path)
+void Application::processLevels(const QString& path, const QStringList& files)
 {
-    auto lvl_xml_iter = QDirIterator(path + "/levels", {"*.xml"}, QDir::Filter::Files | QDir::Filter::NoDotAndDotDot | QDir::Filter::NoSymLinks);
+    // the budget reorders the levels, the prefetcher follows that order
+    const auto jobs = m_Settings.m_MemoryBudget > 0 ? MemoryBudgetScheduler::order(files) : MemoryBudgetScheduler::Jobs();
+    auto ordered_files = files;
+
+    if(!jobs.empty())
+    {
+        ordered_files.clear();
+
+        for(const auto& job : jobs)
+            ordered_files.push_back(job.m_File);
+    }
+
+    // dependencies are scanned by the prefetch thread as levels come into its window
+    auto prefetcher = Prefetcher(size_t(m_Settings.m_PrefetchWindow) * 1024 * 1024);
+    prefetcher.start(ordered_files, LevelParser::dependencies);
 
-    QStringList level_files;
+    const auto export_function = [settings = m_Settings, backends = ExportBackend::create(m_Settings), &prefetcher](const auto& file, const auto& path) -> void {
+        prefetcher.started();
 
-    while(lvl_xml_iter.hasNext())
-        level_files.push_back(lvl_xml_iter.next());
+        TraceSpan span("export level", QFileInfo(file).baseName());
+        ShardManifest::Timer timer("levels", QFileInfo(file).baseName());
 
-    const auto export_function = [](const auto& file, const auto& path) -> void {
         LevelParser parser;
-        const auto level = parser.parse(file);
+        auto level = parser.parse(file);
 
         if(!level)
             return;
 
-        LevelWriter(path + "/lv_export/" + level->m_LevelName).writeLevel(*level);
+        if(MemoryReport::isEnabled())
+            MemoryReport::addLevel(level->m_LevelName, MemoryFootprint::estimate(*level));
+
+        if(settings.m_DeduplicateMeshes)
+            level = MeshDeduplicator("levels").dedupe(*level);
+
+        // sheets are shared between levels, each one is sliced once per run
+        if(settings.m_ExtractFlipbooks)
+        {
+            for(const auto& bp : level->m_BackgroundPlanes)
+                FlipbookExtractor(path + "/flipbooks").extract(bp.m_Geometry.m_Texture);
+
+            for(const auto& car : level->m_Characters)
+                FlipbookExtractor(path + "/flipbooks").extract(car.m_Geometry.m_Texture);
+        }
+
+        if(settings.m_CullHiddenFaces)
+            level = TrileCuller().cull(*level);
+
+        if(settings.m_MergeCoplanarFaces)
+            level = FaceMerger().merge(*level);
+
+        if(settings.m_OptimizeMeshes)
+            level = MeshOptimizer().optimize(*level);
+
+        const auto out_path = path + "/lv_export/" + level->m_LevelName;
+
+        if(settings.m_AtlasSize > 0)
+            level = TextureAtlasBuilder(out_path, settings.m_AtlasSize).build(*level);
+
+        if(settings.m_CompressTextures)
+            level = TextureTranscoder(out_path, settings.m_Mipmaps).transcode(*level);
+
+        // batching, instancing and alpha are worked out once and shared by every format
+        const auto write_level = [&settings, &backends, &out_path](const Level& level) -> void {
+            const auto analysis = LevelAnalyzer(settings.m_BatchLevels, settings.m_WriteStats).analyze(level);
+
+            for(const auto& backend : backends)
+                backend->writeLevel(out_path, level, analysis);
+        };
+
+        if(settings.m_ChunkSize == 0)
+        {
+            write_level(*level);
+            return;
+        }
+
+        // one file per chunk and an index with the chunk bounds
+        auto chunks = LevelChunker(settings.m_ChunkSize).chunk(*level);
+
+        for(auto& chunk : chunks)
+        {
+            write_level(chunk.m_Level);
+
+            if(settings.m_NumLods == 0)
+                continue;
+
+            // lods of the baked chunk, one merged mesh per material
+            chunk.m_Lods = LodGenerator(settings.m_NumLods).generate(chunk.m_Level.m_LevelName, LevelBatcher().batch(chunk.m_Level));
+
+            for(auto& lod : chunk.m_Lods)
+            {
+                auto lod_level = Level();
+
+                lod_level.m_LevelName = lod.m_Name;
+                lod_level.m_BakedGeometries = std::move(lod.m_Geometries);
+
+                write_level(lod_level);
+            }
+        }
+
+        ChunkIndexWriter(out_path).writeIndex(level->m_LevelName, settings.m_ChunkSize, chunks, settings.extensions());
     };
 
+    // large levels must not all build their scenes at the same time
+    if(m_Settings.m_MemoryBudget > 0)
+    {
+        const auto budget = size_t(m_Settings.m_MemoryBudget) * 1024 * 1024;
+
+        MemoryBudgetScheduler(budget).run(jobs, [&export_function, &path](const QString& file) { export_function(file, path); });
+        return;
+    }
+
     auto waiter = QFutureSynchronizer<void>();
 
-    for(const auto& file : level_files)
+    for(const auto& file : ordered_files)
         waiter.addFuture(QtConcurrent::run(export_function, file, path));
 
     waiter.waitForFinished();
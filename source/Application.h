@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ExportSettings.h"
+
 #include <QtWidgets/QApplication>
 
 class Application : public QApplication
@@ -13,7 +15,12 @@ public slots:
     void onRun();
 
 private:
-    void processArtObjects(const QString& path);
-    void processTrileSets(const QString& path);
-    void processLevels(const QString& path);
+    bool parseArguments();
+
+    void processArtObjects(const QString& path, const QStringList& files);
+    void processTrileSets(const QString& path, const QStringList& files);
+    void processLevels(const QString& path, const QStringList& files);
+
+private:
+    ExportSettings m_Settings;
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QtCore/QStringList>
+
+struct ExportSettings
+{
+    // empty asks for the directory
+    QString m_InputPath = {};
+
+    // worker threads, 0 uses one per core
+    int m_NumThreads = 0;
+
+    // input MB read ahead of the workers, 0 disables prefetching
+    int m_PrefetchWindow = 0;
+
+    // estimated memory of the level jobs running at once in MB, 0 starts them all
+    int m_MemoryBudget = 0;
+
+    // this process exports part i of N, 0 of 0 exports everything
+    int m_ShardIndex = 0;
+    int m_ShardCount = 0;
+
+    // combine the manifests of that many shards instead of exporting
+    int m_MergeShards = 0;
+
+    // chrome trace event file, empty disables tracing
+    QString m_TracePath = {};
+
+    // per stage hardware counter table at the end of the run
+    bool m_ProfileCounters = false;
+
+    // json with cache footprints, level footprints and peak memory, empty disables it
+    QString m_MemoryReportPath = {};
+
+    bool m_WriteObj = true;
+    bool m_WriteGlb = false;
+    bool m_QuantizeGlb = false;
+    bool m_WriteStats = false;
+
+    bool m_BatchLevels = false;
+    bool m_CullHiddenFaces = false;
+    bool m_MergeCoplanarFaces = false;
+    bool m_OptimizeMeshes = false;
+    bool m_ExtractFlipbooks = false;
+    bool m_DeduplicateMeshes = false;
+
+    bool m_CompressTextures = false;
+    bool m_Mipmaps = false;
+
+    // atlas edge length in pixels, 0 keeps one texture per plane
+    int m_AtlasSize = 0;
+
+    // edge length of the level chunks in trile units, 0 writes whole levels
+    int m_ChunkSize = 0;
+
+    // decimated variants per art object and level chunk, 0 disables lod generation
+    int m_NumLods = 0;
+
+    QStringList extensions() const
+    {
+        auto result = QStringList();
+
+        if(m_WriteObj)
+            result.push_back("obj");
+
+        if(m_WriteGlb)
+            result.push_back("glb");
+
+        return result;
+    }
+};
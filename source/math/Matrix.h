@@ -0,0 +1,7 @@
+#pragma once
+
+#include <Eigen/Sparse>
+
+using Mat2f = Eigen::Matrix<float, 2, 2>;
+using Mat3f = Eigen::Matrix<float, 3, 3>;
+using Mat3Xf = Eigen::Matrix<float, 3, Eigen::Dynamic>;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "math/Matrix.h"
+#include "math/Quaternion.h"
+#include "math/Vector.h"
+
+#include <array>
+#include <numbers>
+
+// rotation of a trile emplacement around the y axis, matches aiQuaternion(angle, 0, 0)
+inline const QuaternionF& trileOrientation(const unsigned int& orientation)
+{
+    static const auto orientations = []() {
+        const auto pi = std::numbers::pi_v<float>;
+        const auto angles = std::array<float, 4>{pi, pi * -0.5f, 0.0f, pi * 0.5f};
+
+        auto result = std::array<QuaternionF, 4>();
+
+        for(size_t i = 0; i < angles.size(); i++)
+            result[i] = QuaternionF(Eigen::AngleAxisf(angles[i], Vec3f::UnitY()));
+
+        return result;
+    }();
+
+    static const auto identity = QuaternionF::Identity();
+
+    return orientation < orientations.size() ? orientations[orientation] : identity;
+}
+
+inline const Mat3f& trileOrientationMatrix(const unsigned int& orientation)
+{
+    static const auto matrices = []() {
+        auto result = std::array<Mat3f, 4>();
+
+        for(unsigned int i = 0; i < result.size(); i++)
+            result[i] = trileOrientation(i).toRotationMatrix();
+
+        return result;
+    }();
+
+    static const auto identity = Mat3f::Identity().eval();
+
+    return orientation < matrices.size() ? matrices[orientation] : identity;
+}
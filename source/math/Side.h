@@ -0,0 +1,23 @@
+#pragma once
+
+#include "math/Vector.h"
+
+#include <array>
+
+// side indices as stored in the Normal element of trile geometry, unsigned so any index wraps into the table,
+// callers skip vertices without a side (-1)
+inline const Vec3f& sideNormal(const unsigned int& side)
+{
+    static const auto normals = std::array<Vec3f, 6>{Vec3f{-1, 0, 0}, Vec3f{0, -1, 0}, Vec3f{0, 0, -1},  //
+                                                     Vec3f{1, 0, 0},  Vec3f{0, 1, 0},  Vec3f{0, 0, 1}};
+
+    return normals[side % 6];
+}
+
+inline int sideIndex(const Vec3f& normal)
+{
+    Eigen::Index axis = 0;
+    normal.cwiseAbs().maxCoeff(&axis);
+
+    return normal[axis] < 0.0f ? int(axis) : int(axis) + 3;
+}
@@ -5,4 +5,5 @@
 using Vec2f = Eigen::Matrix<float, 2, 1>;
 using Vec3f = Eigen::Matrix<float, 3, 1>;
 
+using Vec3i = Eigen::Matrix<int, 3, 1>;
 using Vec3ui = Eigen::Matrix<unsigned int, 3, 1>;
\ No newline at end of file
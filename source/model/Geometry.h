@@ -5,6 +5,7 @@
 
 #include <QtCore/QString>
 
+#include <cstdint>
 #include <vector>
 
 struct Geometry
@@ -19,4 +20,7 @@ struct Geometry
     float m_Opacity = 1.0f;
     bool m_DoubleSided = true;
     bool m_IsPlane = false;
+
+    // content hash of vertices and indices as parsed, stages that change the mesh do not update it
+    uint64_t m_Hash = 0;
 };
\ No newline at end of file
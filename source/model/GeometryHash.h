@@ -0,0 +1,49 @@
+#pragma once
+
+#include "model/Geometry.h"
+
+#include <cstdint>
+#include <cstring>
+
+// 64 bit fnv-1a of vertices and indices, never 0 since 0 marks geometry that was never hashed
+inline uint64_t geometryHash(const Geometry& geometry)
+{
+    constexpr uint64_t fnv_offset = 14695981039346656037ull;
+    constexpr uint64_t fnv_prime = 1099511628211ull;
+
+    auto result = fnv_offset;
+
+    const auto hash_word = [&result](const uint32_t& word) -> void { result = (result ^ word) * fnv_prime; };
+
+    // -0 and 0 compare equal, so they have to hash equal as well
+    const auto hash_float = [&hash_word](const float& value) -> void {
+        const auto canonical = value + 0.0f;
+
+        uint32_t word;
+        std::memcpy(&word, &canonical, sizeof(word));
+
+        hash_word(word);
+    };
+
+    hash_word(uint32_t(geometry.m_Vertices.size()));
+    hash_word(uint32_t(geometry.m_Indices.size()));
+
+    for(const auto& vertex : geometry.m_Vertices)
+    {
+        for(int i = 0; i < 3; i++)
+            hash_float(vertex.m_Position[i]);
+
+        for(int i = 0; i < 3; i++)
+            hash_float(vertex.m_Normal[i]);
+
+        for(int i = 0; i < 2; i++)
+            hash_float(vertex.m_TextureCoordinate[i]);
+
+        hash_word(uint32_t(vertex.m_Side));
+    }
+
+    for(const auto& index : geometry.m_Indices)
+        hash_word(uint32_t(index));
+
+    return result != 0 ? result : 1;
+}
@@ -17,6 +17,9 @@ struct Level
     using BackgroundPlanes = std::vector<BackgroundPlane>;
     using Characters = std::vector<Character>;
 
+    // world space geometry produced by processing stages
+    using BakedGeometries = std::vector<Geometry>;
+
     QString m_LevelName = {};
 
     QString m_TrileSetName = {};
@@ -29,4 +32,6 @@ struct Level
     BackgroundPlanes m_BackgroundPlanes = {};
 
     Characters m_Characters = {};
+
+    BakedGeometries m_BakedGeometries = {};
 };
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "model/Geometry.h"
+
+#include "math/Quaternion.h"
+#include "math/Vector.h"
+
+#include <QtCore/QString>
+
+#include <map>
+#include <vector>
+
+// translation, rotation, scale
+using Instance = std::tuple<Vec3f, QuaternionF, Vec3f>;
+using Instances = std::vector<Instance>;
+
+// one mesh of the level and every place it is put, the geometry points into the analyzed level
+struct InstanceGroup
+{
+    QString m_Name = {};
+    const Geometry* m_Geometry = nullptr;
+    Instances m_Instances = {};
+};
+
+using InstanceGroups = std::map<QString, InstanceGroup>;
+
+// format independent facts about a level, gathered once and handed to every backend
+struct LevelAnalysis
+{
+    using Batches = std::vector<Geometry>;
+
+    bool m_Batched = false;
+
+    InstanceGroups m_InstanceGroups = {};
+    Batches m_Batches = {};
+
+    // only counted when a stats backend is written
+    size_t m_NumOpaque = 0;
+    size_t m_NumCutout = 0;
+    size_t m_NumTranslucent = 0;
+};
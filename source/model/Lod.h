@@ -0,0 +1,21 @@
+#pragma once
+
+#include "model/Geometry.h"
+
+#include <QtCore/QString>
+
+#include <vector>
+
+struct Lod
+{
+    using Geometries = std::vector<Geometry>;
+
+    QString m_Name = {};
+    Geometries m_Geometries = {};
+    size_t m_Triangles = 0;
+
+    // largest deviation from the full detail geometry in object units
+    float m_Error = 0.0f;
+};
+
+using Lods = std::vector<Lod>;
@@ -6,6 +6,14 @@
 
 #include <vector>
 
+enum class TextureAlpha
+{
+    Unknown,
+    Opaque,
+    Cutout,
+    Translucent
+};
+
 struct Texture
 {
     using TextureAnimationOffsets = std::vector<std::tuple<unsigned int, Vec2f, Vec2f>>;
@@ -15,5 +23,6 @@ struct Texture
     bool m_IsAnimated = false;
     unsigned int m_Width = 0;
     unsigned int m_Height = 0;
+    TextureAlpha m_Alpha = TextureAlpha::Unknown;
     TextureAnimationOffsets m_TextureAnimationOffsets = {};
 };
\ No newline at end of file
@@ -7,4 +7,5 @@ struct Vertex
     Vec3f m_Position = Vec3f::Zero();
     Vec3f m_Normal = Vec3f::UnitY();
     Vec2f m_TextureCoordinate = Vec2f::Zero();
+    int m_Side = -1;
 };
\ No newline at end of file
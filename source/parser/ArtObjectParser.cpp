@@ -2,6 +2,8 @@
 
 #include "parser/GeometryParser.h"
 
+#include "profiling/Trace.h"
+
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 
@@ -31,6 +33,8 @@ ArtObjectParser::GeometryResult ArtObjectParser::parse(const QString& path) noex
     m_Document.clear();
 
     // load
+    TraceSpan load_span("load art object xml", name, ProfileStage::Parse);
+
     auto xml_file = QFile(path);
 
     if(!xml_file.exists())
@@ -50,7 +54,11 @@ ArtObjectParser::GeometryResult ArtObjectParser::parse(const QString& path) noex
         return {};
     }
 
+    load_span.end();
+
     // parse
+    TraceSpan read_span("read art object", name, ProfileStage::Parse);
+
     const auto art_obj_elem = m_Document.firstChildElement("ArtObject");
 
     if(art_obj_elem.isNull())
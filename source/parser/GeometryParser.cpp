@@ -1,5 +1,7 @@
 #include "parser/GeometryParser.h"
 
+#include "model/GeometryHash.h"
+
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
@@ -35,6 +37,7 @@ GeometryParser::GeometryResult GeometryParser::parseGeometry(const QDomElement&
     Geometry result;
     result.m_Vertices = std::move(*vertices);
     result.m_Indices = std::move(*indices);
+    result.m_Hash = geometryHash(result);
 
     return result;
 }
@@ -119,6 +122,8 @@ GeometryParser::VerticesResult GeometryParser::parseVertices(const QDomElement&
             default: return {};
         }
 
+        vertex.m_Side = side_index;
+
         // texture coordinate
         const auto vec2_elem = texture_coord_elem.firstChildElement("Vector2");
 
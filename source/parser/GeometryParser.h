@@ -18,7 +18,7 @@ public:
 
     GeometryResult parseGeometry(const QDomElement& elem);
 
-private:
+protected:
     VerticesResult parseVertices(const QDomElement& elem);
     IndicesResult parseIndices(const QDomElement& elem);
 
@@ -4,15 +4,49 @@
 #include "parser/TextureParser.h"
 #include "parser/TrileSetParser.h"
 
+#include "profiling/MemoryFootprint.h"
+#include "profiling/Trace.h"
+
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QFutureSynchronizer>
 #include <QtCore/QMutexLocker>
+#include <QtCore/QXmlStreamReader>
 
 #include <QtGui/QImage>
 
+#include <QtConcurrent/QtConcurrentRun>
+
 #include <qdebug.h>
 
+namespace
+{
+    // the map lock only finds or adds the entry, the load runs outside of it
+    template<class Cache, class Load>
+    auto cached(QMutex& mutex, Cache& cache, const QString& key, const char* waitName, const Load& load)
+    {
+        auto entry = typename Cache::mapped_type();
+
+        {
+            TraceSpan wait_span(waitName, key, ProfileStage::CacheLookup);
+            QMutexLocker locker(&mutex);
+            wait_span.end();
+
+            auto& cache_entry = cache[key];
+
+            if(!cache_entry)
+                cache_entry = std::make_shared<typename Cache::mapped_type::element_type>();
+
+            entry = cache_entry;
+        }
+
+        std::call_once(entry->m_Loaded, [&entry, &load]() { entry->m_Value = load(); });
+
+        return entry->m_Value;
+    }
+}
+
 QMutex LevelParser::sm_TrileSetCacheMutex = {};
 LevelParser::TrileSetCache LevelParser::sm_TrileSetCache = {};
 
@@ -46,6 +80,8 @@ LevelParser::LevelResult LevelParser::parse(const QString& path) noexcept
     m_Document.clear();
 
     // load
+    TraceSpan load_span("load level xml", name, ProfileStage::Parse);
+
     auto xml_file = QFile(path);
 
     if(!xml_file.exists())
@@ -65,6 +101,8 @@ LevelParser::LevelResult LevelParser::parse(const QString& path) noexcept
         return {};
     }
 
+    load_span.end();
+
     // parse
     const auto level_elem = m_Document.firstChildElement("Level");
 
@@ -83,58 +121,66 @@ LevelParser::LevelResult LevelParser::parse(const QString& path) noexcept
 
     result.m_LevelName = level_elem.attribute("name");
 
+    // the document is only walked on this thread, qdom is not thread safe
     // Size
     // StartingPosition
     // Volumes
     // Scripts
     // Triles
-    auto trile_emplacements = std::move(readTrileEmplacements(level_elem));
+    TraceSpan triles_span("read triles", name, ProfileStage::Parse);
+    auto trile_emplacements = readTrileEmplacements(level_elem);
+    triles_span.end();
 
     if(!trile_emplacements)
         return {};
 
-    auto trile_geometries = parseTrileEmplacements(*trile_emplacements, result.m_TrileSetName);
-
-    if(!trile_geometries)
-        return {};
-
     // ArtObjects
-    auto art_objects = std::move(readArtObjects(level_elem));
+    TraceSpan art_objects_span("read art objects", name, ProfileStage::Parse);
+    auto art_objects = readArtObjects(level_elem);
+    art_objects_span.end();
 
     if(!art_objects)
         return {};
-    
-    auto art_object_geometries = parseArtObjects(*art_objects);
-
-    if(!art_object_geometries)
-        return {};
 
     // BackgroundPlanes
-    auto background_planes = std::move(readBackgroundPlanes(level_elem));
-
-    if(!background_planes)
-        return {};
-
-    background_planes = parseBackgroundPlanes(*background_planes);
+    TraceSpan background_planes_span("read background planes", name, ProfileStage::Parse);
+    auto background_planes = readBackgroundPlanes(level_elem);
+    background_planes_span.end();
 
     if(!background_planes)
         return {};
 
     // Groups
     // NonplayerCharacters
-    auto characters = std::move(readCharacters(level_elem));
+    TraceSpan characters_span("read characters", name, ProfileStage::Parse);
+    auto characters = readCharacters(level_elem);
+    characters_span.end();
 
     if(!characters)
         return {};
 
-    characters = parseCharacters(*characters);
-
-    if(!characters)
-        return {};
     // Paths
     // MutedLoops
     // AmbienceTracks
 
+    // the sections load independent dependencies, each one runs as a subtask on the pool
+    auto art_object_geometries = ArtObjectGeometriesResult();
+
+    auto waiter = QFutureSynchronizer<void>();
+
+    waiter.addFuture(QtConcurrent::run([this, &art_objects, &art_object_geometries]() { art_object_geometries = parseArtObjects(*art_objects); }));
+    waiter.addFuture(QtConcurrent::run([this, &background_planes]() { background_planes = parseBackgroundPlanes(*background_planes); }));
+    waiter.addFuture(QtConcurrent::run([this, &characters]() { characters = parseCharacters(*characters); }));
+
+    // the trile set is usually the largest load, it stays on this thread
+    auto trile_geometries = parseTrileEmplacements(*trile_emplacements, result.m_TrileSetName);
+
+    // a subtask nobody picked up yet runs here instead of waiting
+    waiter.waitForFinished();
+
+    if(!trile_geometries || !art_object_geometries || !background_planes || !characters)
+        return {};
+
     result.m_TrileEmplacements = std::move(*trile_emplacements);
     result.m_TrileGeometries = std::move(*trile_geometries);
 
@@ -148,6 +194,116 @@ LevelParser::LevelResult LevelParser::parse(const QString& path) noexcept
     return result;
 }
 
+CacheUsages LevelParser::cacheUsage()
+{
+    auto trile_sets = CacheUsage{"trileSets", {}};
+    auto art_objects = CacheUsage{"artObjects", {}};
+    auto textures = CacheUsage{"textures", {}};
+
+    {
+        QMutexLocker locker(&sm_TrileSetCacheMutex);
+
+        for(const auto& trile_set : sm_TrileSetCache)
+        {
+            if(!trile_set.second->m_Value)
+                continue;
+
+            auto bytes = size_t(0);
+
+            for(const auto& trile : *trile_set.second->m_Value)
+                bytes += MemoryFootprint::estimate(trile.second);
+
+            trile_sets.m_Entries.push_back({trile_set.first, bytes});
+        }
+    }
+
+    {
+        QMutexLocker locker(&sm_ArtObjectCacheMutex);
+
+        for(const auto& art_object : sm_ArtObjectCache)
+            if(art_object.second->m_Value)
+                art_objects.m_Entries.push_back({art_object.first, MemoryFootprint::estimate(*art_object.second->m_Value)});
+    }
+
+    {
+        QMutexLocker locker(&sm_TextureCacheMutex);
+
+        for(const auto& texture : sm_TextureCache)
+            if(texture.second->m_Value)
+                textures.m_Entries.push_back({texture.first, MemoryFootprint::estimate(*texture.second->m_Value)});
+    }
+
+    return {trile_sets, art_objects, textures};
+}
+
+QStringList LevelParser::dependencies(const QString& path)
+{
+    QFile xml_file(path);
+
+    if(!xml_file.open(QIODevice::OpenModeFlag::ReadOnly))
+        return {};
+
+    const auto content_dir = QFileInfo(path).absolutePath() + "/../";
+
+    auto result = QStringList{path};
+
+    const auto add = [&result](const QString& file) -> void {
+        if(!result.contains(file) && QFile::exists(file))
+            result.push_back(file);
+    };
+
+    // same layout the parsers resolve names against
+    auto npc_name = QString();
+    QXmlStreamReader reader(&xml_file);
+
+    while(!reader.atEnd())
+    {
+        if(reader.readNext() != QXmlStreamReader::TokenType::StartElement)
+            continue;
+
+        const auto attributes = reader.attributes();
+
+        if(reader.name() == QString("Level"))
+        {
+            const auto trile_set = content_dir + "trile sets/" + attributes.value("trileSetName").toString();
+
+            add(trile_set + ".xml");
+            add(trile_set + ".png");
+        }
+        else if(reader.name() == QString("ArtObjectInstance"))
+        {
+            const auto art_object = content_dir + "art objects/" + attributes.value("name").toString();
+
+            add(art_object + ".xml");
+            add(art_object + ".png");
+        }
+        else if(reader.name() == QString("BackgroundPlane"))
+        {
+            const auto plane = content_dir + "background planes/" + attributes.value("textureName").toString().replace('\\', '/');
+
+            add(plane + ".png");
+            add(plane + ".xml");
+            add(plane + ".ani.png");
+        }
+        else if(reader.name() == QString("NpcInstance"))
+        {
+            npc_name = attributes.value("name").toString();
+        }
+        else if(reader.name() == QString("NpcActionContent") && !npc_name.isEmpty())
+        {
+            // only the first action is exported
+            const auto character = content_dir + "character animations/" + npc_name + "/" + attributes.value("animationName").toString();
+
+            add(character + ".xml");
+            add(character + ".ani.png");
+
+            npc_name.clear();
+        }
+    }
+
+    return result;
+}
+
 LevelParser::TrileEmplacementsResult LevelParser::readTrileEmplacements(const QDomElement& elem)
 {
     // read TrileEmplacement
@@ -362,15 +518,10 @@ LevelParser::ArtObjectsResult LevelParser::readArtObjects(const QDomElement& ele
 
 LevelParser::TrileGeometriesResult LevelParser::parseTrileEmplacements(const Level::TrileEmplacements& emplacements, const QString& trileSetName)
 {
-    // find trile set in cache
-    const auto trile_set = [this, &trileSetName]() -> Level::TrileGeometries {
-        QMutexLocker locker(&sm_TrileSetCacheMutex);
-
-        const auto trile_set_find_iter = sm_TrileSetCache.find(trileSetName);
-
-        if(trile_set_find_iter != sm_TrileSetCache.cend())
-            return trile_set_find_iter->second;
+    // find trile set in cache, misses load outside the lock and their parser spans count as parse
+    TraceSpan lookup_span("trile set cache", trileSetName, ProfileStage::CacheLookup);
 
+    const auto trile_set = cached(sm_TrileSetCacheMutex, sm_TrileSetCache, trileSetName, "wait trile set cache", [this, &trileSetName]() -> TrileGeometriesResult {
         // load triles
         const auto trile_sets_dir = QDir(m_Path + "/../trile sets");
 
@@ -383,17 +534,17 @@ LevelParser::TrileGeometriesResult LevelParser::parseTrileEmplacements(const Lev
             return {};
 
         TrileSetParser parser;
-        const auto triles_set = parser.parse(trile_set_path);
+        auto triles_set = parser.parse(trile_set_path);
 
         if(triles_set.empty())
             return {};
 
-        sm_TrileSetCache.insert({trileSetName, triles_set});
-
         return triles_set;
-    }();
+    });
 
-    if(trile_set.empty())
+    lookup_span.end();
+
+    if(!trile_set)
         return {};
 
     Level::TrileGeometries result;
@@ -407,9 +558,9 @@ LevelParser::TrileGeometriesResult LevelParser::parseTrileEmplacements(const Lev
         if(emplacement.m_Id == -1)
             continue;
 
-        const auto find_result = trile_set.find(emplacement.m_Id);
+        const auto find_result = trile_set->find(emplacement.m_Id);
 
-        if(find_result == trile_set.cend())
+        if(find_result == trile_set->cend())
             return {};
 
         result.insert(*find_result);
@@ -428,35 +579,24 @@ LevelParser::ArtObjectGeometriesResult LevelParser::parseArtObjects(const Level:
             continue;
 
         // find art object set in cache
-        auto art_object = [this](const QString& artObjectName) -> std::optional<Geometry> {
-            QMutexLocker locker(&sm_ArtObjectCacheMutex);
-
-            const auto art_object_find_iter = sm_ArtObjectCache.find(artObjectName);
-
-            if(art_object_find_iter != sm_ArtObjectCache.cend())
-                return art_object_find_iter->second;
+        TraceSpan lookup_span("art object cache", artObject.m_Name, ProfileStage::CacheLookup);
 
+        auto art_object = cached(sm_ArtObjectCacheMutex, sm_ArtObjectCache, artObject.m_Name, "wait art object cache", [this, &artObject]() -> std::optional<Geometry> {
             // load art object
             const auto art_objects_dir = QDir(m_Path + "/../art objects");
 
             if(!art_objects_dir.exists())
                 return {};
 
-            const auto art_object_path = art_objects_dir.absolutePath() + "/" + artObjectName + ".xml";
+            const auto art_object_path = art_objects_dir.absolutePath() + "/" + artObject.m_Name + ".xml";
 
             if(!QFile(art_object_path).exists())
                 return {};
 
-            ArtObjectParser parser;
-            auto art_object_result = parser.parse(art_object_path);
-
-            if(!art_object_result)
-                return {};
-
-            sm_ArtObjectCache.insert({artObjectName, *art_object_result});
+            return ArtObjectParser().parse(art_object_path);
+        });
 
-            return *art_object_result;
-        }(artObject.m_Name);
+        lookup_span.end();
 
         if(!art_object)
             return {};
@@ -521,31 +661,9 @@ LevelParser::BackgroundPlanesResult LevelParser::readBackgroundPlanes(const QDom
         else
             return {};
 
-        const auto texture_path = QDir(m_Path + "/../background planes").absolutePath();
-
-        const auto texture = [this, &texture_path, &background_plane, &animated]() -> TextureResult {
-            QMutexLocker locker(&sm_TextureCacheMutex);
-
-            const auto cache_key = texture_path + "/" + background_plane.m_Name;
-            const auto cache_texture = sm_TextureCache.find(cache_key);
-
-            if(cache_texture != sm_TextureCache.cend())
-                return cache_texture->second;
-
-            const auto loaded_texture = TextureParser().parse(texture_path, background_plane.m_Name, animated);
-
-            if(!loaded_texture)
-                return {};
-
-            sm_TextureCache.insert({cache_key, *loaded_texture});
-
-            return loaded_texture;
-        }();
-
-        if(!texture)
-            return {};
-
-        background_plane.m_Geometry.m_Texture = std::move(*texture);
+        // only names the texture, parseBackgroundPlanes loads it
+        background_plane.m_Geometry.m_Texture.m_TextureName = background_plane.m_Name;
+        background_plane.m_Geometry.m_Texture.m_IsAnimated = animated;
 
         // read opacity
         if(!background_plane_elem.hasAttribute("opacity"))
@@ -651,15 +769,24 @@ LevelParser::BackgroundPlanesResult LevelParser::parseBackgroundPlanes(const Lev
 {
     Level::BackgroundPlanes result;
 
+    const auto texture_path = QDir(m_Path + "/../background planes").absolutePath();
+
     for(const auto& backgroundPlane : backgroundPlanes)
     {
-        const auto& texture = backgroundPlane.m_Geometry.m_Texture;
+        const auto loaded_texture = loadTexture(texture_path, backgroundPlane.m_Geometry.m_Texture);
+
+        if(!loaded_texture)
+            return {};
+
+        const auto& texture = *loaded_texture;
 
         const auto geom_w = float(texture.m_Width / 16);
         const auto geom_h = float(texture.m_Height / 16);
 
         auto back_ground_plane = backgroundPlane;
 
+        back_ground_plane.m_Geometry.m_Texture = texture;
+
         back_ground_plane.m_Geometry.m_IsPlane = true;
         back_ground_plane.m_Geometry.m_Vertices = Geometry::Vertices(4);
         back_ground_plane.m_Geometry.m_Indices = Geometry::Indices(6);
@@ -781,33 +908,9 @@ LevelParser::CharactersResult LevelParser::readCharacters(const QDomElement& ele
         if(actions.empty())
             return {};
 
-        // read texture
-        const auto texture_path = QDir(m_Path + "/../character animations").absolutePath();
-        const auto action_name = actions[0].second;
-
-        const auto texture = [this, &texture_path, &character, &action_name]() -> TextureResult {
-            QMutexLocker locker(&sm_TextureCacheMutex);
-
-            const auto cache_key = texture_path + "/" + character.m_Name + "/" + action_name;
-            const auto cache_texture = sm_TextureCache.find(cache_key);
-
-            if(cache_texture != sm_TextureCache.cend())
-                return cache_texture->second;
-
-            const auto loaded_texture = TextureParser().parse(texture_path, character.m_Name + "/" + action_name, true);
-
-            if(!loaded_texture)
-                return {};
-
-            sm_TextureCache.insert(std::make_pair(cache_key, *loaded_texture));
-
-            return loaded_texture;
-        }();
-
-        if(!texture)
-            return {};
-
-        character.m_Geometry.m_Texture = std::move(*texture);
+        // only names the texture of the first action, parseCharacters loads it
+        character.m_Geometry.m_Texture.m_TextureName = character.m_Name + "/" + actions[0].second;
+        character.m_Geometry.m_Texture.m_IsAnimated = true;
 
         // read position
         const auto position_elem = npc_instance.firstChildElement("Position");
@@ -845,15 +948,24 @@ LevelParser::CharactersResult LevelParser::parseCharacters(const Level::Characte
 {
     Level::Characters result;
 
+    const auto texture_path = QDir(m_Path + "/../character animations").absolutePath();
+
     for(const auto& character : characters)
     {
-        const auto& texture = character.m_Geometry.m_Texture;
+        const auto loaded_texture = loadTexture(texture_path, character.m_Geometry.m_Texture);
+
+        if(!loaded_texture)
+            return {};
+
+        const auto& texture = *loaded_texture;
 
         const auto geom_w = (float)texture.m_Width / float(16);
         const auto geom_h = (float)texture.m_Height / float(16);
 
         auto character_res = character;
 
+        character_res.m_Geometry.m_Texture = texture;
+
         character_res.m_Geometry.m_IsPlane = true;
         character_res.m_Geometry.m_Vertices = Geometry::Vertices(4);
         character_res.m_Geometry.m_Indices = Geometry::Indices(6);
@@ -886,4 +998,13 @@ LevelParser::CharactersResult LevelParser::parseCharacters(const Level::Characte
     }
 
     return result;
+}
+
+LevelParser::TextureResult LevelParser::loadTexture(const QString& path, const Texture& texture)
+{
+    TraceSpan lookup_span("texture cache", texture.m_TextureName, ProfileStage::CacheLookup);
+
+    return cached(sm_TextureCacheMutex, sm_TextureCache, path + "/" + texture.m_TextureName, "wait texture cache", [&path, &texture]() -> TextureResult {
+        return TextureParser().parse(path, texture.m_TextureName, texture.m_IsAnimated);
+    });
 }
\ No newline at end of file
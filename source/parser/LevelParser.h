@@ -3,11 +3,18 @@
 #include "model/Level.h"
 #include "model/Texture.h"
 
+#include "profiling/MemoryReport.h"
+
 #include <QtCore/QString>
 #include <QtCore/QMutex>
 
 #include <QtXml/QDomDocument>
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+
 class LevelParser
 {
     using LevelResult = std::optional<Level>;
@@ -22,9 +29,17 @@ class LevelParser
     using CharactersResult = std::optional<Level::Characters>;
     using TextureResult = std::optional<Texture>;
 
-    using TrileSetCache = std::map<QString, Level::TrileGeometries>;
-    using ArtObjectCache = std::map<QString, Geometry>;
-    using TextureCache = std::map<QString, Texture>;
+    // loaded once per key outside the map lock, concurrent requests for one key wait for the first
+    template<class T>
+    struct CacheEntry
+    {
+        std::once_flag m_Loaded;
+        std::optional<T> m_Value;
+    };
+
+    using TrileSetCache = std::map<QString, std::shared_ptr<CacheEntry<Level::TrileGeometries>>>;
+    using ArtObjectCache = std::map<QString, std::shared_ptr<CacheEntry<Geometry>>>;
+    using TextureCache = std::map<QString, std::shared_ptr<CacheEntry<Texture>>>;
 
 public:
     LevelParser();
@@ -32,8 +47,16 @@ public:
 
     LevelResult parse(const QString& path) noexcept;
 
-private:
+    // estimated bytes of every trile set, art object and texture cached so far
+    static CacheUsages cacheUsage();
+
+    // the level xml and every existing file parsing it will open, from a stream scan without a dom
+    static QStringList dependencies(const QString& path);
+
+protected:
     TrileEmplacementsResult readTrileEmplacements(const QDomElement& elem);
+
+private:
     ArtObjectsResult readArtObjects(const QDomElement& elem);
     BackgroundPlanesResult readBackgroundPlanes(const QDomElement& elem);
     CharactersResult readCharacters(const QDomElement& elem);
@@ -43,6 +66,9 @@ private:
     BackgroundPlanesResult parseBackgroundPlanes(const Level::BackgroundPlanes& backgroundPlanes);
     CharactersResult parseCharacters(const Level::Characters& characters);
 
+    // texture named by the read step, from the cache or loaded from path
+    TextureResult loadTexture(const QString& path, const Texture& texture);
+
 private:
     QDomDocument m_Document;
 
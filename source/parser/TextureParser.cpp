@@ -1,11 +1,14 @@
 #include "parser/TextureParser.h"
 
+#include "profiling/Trace.h"
+
+#include "texture/AlphaClassifier.h"
+#include "texture/ImageCache.h"
+
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 
-#include <QtGui/QImage>
-
 TextureParser::TextureParser() : m_Document{}
 {
 }
@@ -30,13 +33,18 @@ TextureParser::TextureResult TextureParser::parse(const QString& path, const QSt
 
     if(!isAnimated)
     {
-        const auto background_plane_image = QImage(result.m_TextureOrgFile);
+        // dimensions straight from the png header
+        const auto background_plane_info = ImageCache::probe(result.m_TextureOrgFile);
 
-        if(background_plane_image.isNull())
+        if(!background_plane_info)
             return {};
 
-        result.m_Width = background_plane_image.width();
-        result.m_Height = background_plane_image.height();
+        result.m_Width = background_plane_info->m_Width;
+        result.m_Height = background_plane_info->m_Height;
+        result.m_Alpha = AlphaClassifier::classify(result.m_TextureOrgFile);
+
+        if(result.m_Alpha == TextureAlpha::Unknown)
+            return {};
 
         return result;
     }
@@ -51,6 +59,8 @@ TextureParser::TextureResult TextureParser::parse(const QString& path, const QSt
     m_Document.clear();
 
     // load
+    TraceSpan load_span("load texture xml", name, ProfileStage::Parse);
+
     auto xml_file = QFile(xml_file_path);
 
     if(!xml_file.exists())
@@ -70,6 +80,8 @@ TextureParser::TextureResult TextureParser::parse(const QString& path, const QSt
         return {};
     }
 
+    load_span.end();
+
     // parse
     const auto animated_texture_pc_elem = m_Document.firstChildElement("AnimatedTexturePC");
 
@@ -154,5 +166,7 @@ TextureParser::TextureResult TextureParser::parse(const QString& path, const QSt
         frame_pc_elem = frame_pc_elem.nextSiblingElement();
     }
 
+    result.m_Alpha = AlphaClassifier::classify(result.m_TextureOrgFile);
+
     return result;
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "parser/GeometryParser.h"
 
+#include "profiling/Trace.h"
+
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
@@ -43,6 +45,8 @@ TrileSetParser::GeometryResults TrileSetParser::parse(const QString& path) noexc
     m_OutPath = m_OutPath + "/" + out_folder_name;
 
     // load
+    TraceSpan load_span("load trile set xml", m_Name, ProfileStage::Parse);
+
     auto xml_file = QFile(path);
 
     if(!xml_file.exists())
@@ -62,7 +66,11 @@ TrileSetParser::GeometryResults TrileSetParser::parse(const QString& path) noexc
         return {};
     }
 
+    load_span.end();
+
     // parse
+    TraceSpan read_span("read trile set", m_Name, ProfileStage::Parse);
+
     const auto trile_set_elem = m_Document.firstChildElement("TrileSet");
 
     if(trile_set_elem.isNull())
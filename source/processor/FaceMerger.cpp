@@ -0,0 +1,353 @@
+#include "processor/FaceMerger.h"
+
+#include "processor/LevelBatcher.h"
+#include "processor/OccupancyGrid.h"
+
+#include "math/Orientation.h"
+#include "math/Side.h"
+
+#include <qdebug.h>
+
+FaceMerger::FaceMerger() : m_LevelName{}, m_MergedGeometries{}, m_MergedFaces{0}
+{
+}
+
+FaceMerger::~FaceMerger()
+{
+}
+
+Level FaceMerger::merge(const Level& level)
+{
+    m_LevelName = level.m_LevelName;
+    m_MergedGeometries.clear();
+    m_MergedFaces = 0;
+
+    const auto grid = OccupancyGrid(level);
+    const auto& size = grid.getSize();
+    const auto num_cells = size_t(size.x()) * size_t(size.y()) * size_t(size.z());
+
+    if(num_cells == 0)
+        return level;
+
+    const auto cell_index = [&size](const Vec3i& c) -> size_t {
+        return (size_t(c.z()) * size.y() + c.y()) * size.x() + c.x();
+    };
+
+    std::map<int, TrileCuller::TrileFaces> trile_faces;
+
+    for(const auto& trile : level.m_TrileGeometries)
+        trile_faces.insert({trile.first, TrileCuller::classify(trile.second)});
+
+    // collect every full quad side, indexed by world side and cell
+    Faces faces;
+    auto face_grid = std::array<std::vector<int>, 6>();
+
+    for(auto& cells : face_grid)
+        cells = std::vector<int>(num_cells, -1);
+
+    for(size_t i = 0; i < level.m_TrileEmplacements.size(); i++)
+    {
+        const auto& te = level.m_TrileEmplacements[i];
+        const auto trile_faces_find_iter = trile_faces.find(te.m_Id);
+
+        if(trile_faces_find_iter == trile_faces.cend())
+            continue;
+
+        const auto cell = OccupancyGrid::cell(te);
+
+        // only the emplacement the grid knows for this cell
+        if(grid.at(cell) != int(i))
+            continue;
+
+        const auto& geometry = level.m_TrileGeometries.at(te.m_Id);
+        const auto& rotation = trileOrientationMatrix(te.m_Orintation);
+
+        for(int side = 0; side < 6; side++)
+        {
+            if(!trile_faces_find_iter->second.m_Covered[side])
+                continue;
+
+            auto face = extractFace(te, geometry, trile_faces_find_iter->second, side);
+
+            if(!face)
+                continue;
+
+            face->m_Emplacement = i;
+
+            const auto world_side = sideIndex(rotation * sideNormal(side));
+
+            face_grid[world_side][cell_index(cell - grid.getMin())] = int(faces.size());
+            faces.push_back(*face);
+        }
+    }
+
+    // greedy rectangle merge per world side and slice
+    auto merged_sides = TrileCuller::SideMasks(level.m_TrileEmplacements.size(), 0);
+    auto used = std::vector<bool>(num_cells, false);
+
+    for(int side = 0; side < 6; side++)
+    {
+        const auto& cells = face_grid[side];
+
+        const auto a = side % 3;
+        const auto u = (a + 1) % 3;
+        const auto v = (a + 2) % 3;
+
+        std::fill(used.begin(), used.end(), false);
+
+        for(int s = 0; s < size[a]; s++)
+        {
+            for(int iv = 0; iv < size[v]; iv++)
+            {
+                for(int iu = 0; iu < size[u]; iu++)
+                {
+                    auto c = Vec3i();
+                    c[a] = s;
+                    c[u] = iu;
+                    c[v] = iv;
+
+                    const auto start_index = cell_index(c);
+                    const auto face_index = cells[start_index];
+
+                    if(face_index < 0 || used[start_index])
+                        continue;
+
+                    const auto& face = faces[face_index];
+
+                    const auto at = [&c, &u, &v](const int& du, const int& dv) -> Vec3i {
+                        auto result = c;
+                        result[u] += du;
+                        result[v] += dv;
+                        return result;
+                    };
+
+                    const auto mergeable = [&](const Vec3i& other) -> bool {
+                        const auto other_index = cell_index(other);
+                        return !used[other_index] && cells[other_index] >= 0 && canMerge(face, faces[cells[other_index]]);
+                    };
+
+                    // grow along u, then along v with full rows
+                    auto w = 1;
+
+                    while(iu + w < size[u] && mergeable(at(w, 0)))
+                        w++;
+
+                    auto h = 1;
+
+                    while(iv + h < size[v])
+                    {
+                        auto row = true;
+
+                        for(int k = 0; k < w && row; k++)
+                            row = mergeable(at(k, h));
+
+                        if(!row)
+                            break;
+
+                        h++;
+                    }
+
+                    for(int l = 0; l < h; l++)
+                        for(int k = 0; k < w; k++)
+                            used[cell_index(at(k, l))] = true;
+
+                    // single faces stay with their trile
+                    if(w * h == 1)
+                        continue;
+
+                    for(int l = 0; l < h; l++)
+                    {
+                        for(int k = 0; k < w; k++)
+                        {
+                            const auto& merged_face = faces[cells[cell_index(at(k, l))]];
+                            merged_sides[merged_face.m_Emplacement] |= 1u << merged_face.m_LocalSide;
+                        }
+                    }
+
+                    addQuad(face, faces[cells[cell_index(at(w - 1, h - 1))]], side);
+
+                    m_MergedFaces += size_t(w * h);
+                }
+            }
+        }
+    }
+
+    if(m_MergedFaces == 0)
+        return level;
+
+    auto result = TrileCuller().removeSides(level, merged_sides);
+
+    for(auto& merged : m_MergedGeometries)
+        result.m_BakedGeometries.push_back(std::move(merged.second));
+
+    m_MergedGeometries.clear();
+
+    qDebug() << "merged: " << m_MergedFaces << " faces in " << level.m_LevelName;
+
+    return result;
+}
+
+size_t FaceMerger::getMergedFaces() const noexcept
+{
+    return m_MergedFaces;
+}
+
+FaceMerger::FaceResult FaceMerger::extractFace(const TrileEmplacement& emplacement, const Geometry& geometry, const TrileCuller::TrileFaces& faces,
+                                               const int& side) const
+{
+    static const auto epsilon = 1e-4f;
+
+    // exactly two triangles spanning the side
+    std::vector<size_t> indices;
+
+    for(size_t i = 0; i < faces.m_TriangleSides.size() && indices.size() <= 6; i++)
+    {
+        if(faces.m_TriangleSides[i] != side)
+            continue;
+
+        indices.push_back(geometry.m_Indices[3 * i + 0]);
+        indices.push_back(geometry.m_Indices[3 * i + 1]);
+        indices.push_back(geometry.m_Indices[3 * i + 2]);
+    }
+
+    if(indices.size() != 6)
+        return {};
+
+    const auto local_u = (side % 3 + 1) % 3;
+    const auto local_v = (side % 3 + 2) % 3;
+
+    const auto& rotation = trileOrientationMatrix(emplacement.m_Orintation);
+    const auto world_side = sideIndex(rotation * sideNormal(side));
+    const auto world_u = (world_side % 3 + 1) % 3;
+    const auto world_v = (world_side % 3 + 2) % 3;
+
+    const auto& first_vertex = geometry.m_Vertices[indices[0]];
+
+    auto world_positions = std::array<Vec3f, 6>();
+    auto plane_positions = std::array<Vec2f, 6>();
+
+    for(size_t i = 0; i < indices.size(); i++)
+    {
+        const auto& vertex = geometry.m_Vertices[indices[i]];
+        const auto& p = vertex.m_Position;
+
+        // only the corners of the side
+        if(std::abs(std::abs(p[local_u]) - 0.5f) > epsilon || std::abs(std::abs(p[local_v]) - 0.5f) > epsilon)
+            return {};
+
+        if(!vertex.m_Normal.isApprox(first_vertex.m_Normal))
+            return {};
+
+        world_positions[i] = rotation * p + emplacement.m_Position;
+        plane_positions[i] = {world_positions[i][world_u], world_positions[i][world_v]};
+    }
+
+    // texture coordinates have to be one affine map of the world position
+    auto plane_edges = Mat2f();
+    plane_edges.col(0) = plane_positions[1] - plane_positions[0];
+    plane_edges.col(1) = plane_positions[2] - plane_positions[0];
+
+    if(std::abs(plane_edges.determinant()) < epsilon)
+        return {};
+
+    auto uv_edges = Mat2f();
+    uv_edges.col(0) = geometry.m_Vertices[indices[1]].m_TextureCoordinate - first_vertex.m_TextureCoordinate;
+    uv_edges.col(1) = geometry.m_Vertices[indices[2]].m_TextureCoordinate - first_vertex.m_TextureCoordinate;
+
+    Face result;
+    result.m_LocalSide = side;
+    result.m_Geometry = &geometry;
+    result.m_Center = emplacement.m_Position;
+    result.m_Normal = rotation * first_vertex.m_Normal;
+    result.m_UvTransform = uv_edges * plane_edges.inverse();
+    result.m_UvOffset = first_vertex.m_TextureCoordinate - result.m_UvTransform * plane_positions[0];
+
+    for(size_t i = 0; i < indices.size(); i++)
+    {
+        const Vec2f uv = result.m_UvTransform * plane_positions[i] + result.m_UvOffset;
+
+        if((uv - geometry.m_Vertices[indices[i]].m_TextureCoordinate).cwiseAbs().maxCoeff() > epsilon)
+            return {};
+    }
+
+    const auto face_normal = (world_positions[1] - world_positions[0]).cross(world_positions[2] - world_positions[0]);
+    result.m_Winding = face_normal.dot(sideNormal(world_side)) > 0.0f;
+
+    return result;
+}
+
+void FaceMerger::addQuad(const Face& first, const Face& last, const int& worldSide)
+{
+    const auto a = worldSide % 3;
+    const auto u = (a + 1) % 3;
+    const auto v = (a + 2) % 3;
+
+    const auto& direction = sideNormal(worldSide);
+
+    // merged rectangle from the first to the last face
+    const auto plane = first.m_Center[a] + 0.5f * direction[a];
+    const auto u0 = first.m_Center[u] - 0.5f;
+    const auto u1 = last.m_Center[u] + 0.5f;
+    const auto v0 = first.m_Center[v] - 0.5f;
+    const auto v1 = last.m_Center[v] + 0.5f;
+
+    const auto corner = [&](const float& pu, const float& pv) -> Vertex {
+        auto result = Vertex();
+
+        result.m_Position[a] = plane;
+        result.m_Position[u] = pu;
+        result.m_Position[v] = pv;
+        result.m_Normal = first.m_Normal;
+        result.m_TextureCoordinate = first.m_UvTransform * Vec2f{pu, pv} + first.m_UvOffset;
+        result.m_Side = sideIndex(first.m_Normal);
+
+        return result;
+    };
+
+    const auto& material = *first.m_Geometry;
+    const auto key = LevelBatcher::materialKey(material);
+
+    auto merged_find_iter = m_MergedGeometries.find(key);
+
+    if(merged_find_iter == m_MergedGeometries.cend())
+    {
+        auto merged = Geometry();
+
+        merged.m_Name = m_LevelName + "_merged_" + QString::number(m_MergedGeometries.size());
+        merged.m_Texture = material.m_Texture;
+        merged.m_Opacity = material.m_Opacity;
+        merged.m_DoubleSided = material.m_DoubleSided;
+        merged.m_IsPlane = material.m_IsPlane;
+
+        merged_find_iter = m_MergedGeometries.insert({key, std::move(merged)}).first;
+    }
+
+    auto& geometry = merged_find_iter->second;
+    const auto first_vertex = geometry.m_Vertices.size();
+
+    geometry.m_Vertices.push_back(corner(u0, v0));
+    geometry.m_Vertices.push_back(corner(u1, v0));
+    geometry.m_Vertices.push_back(corner(u1, v1));
+    geometry.m_Vertices.push_back(corner(u0, v1));
+
+    // (u0, v0), (u1, v0), (u1, v1) winds around +a, keep the winding of the original faces
+    const auto positive = direction[a] > 0.0f;
+    const auto quad = positive == first.m_Winding ? std::array<size_t, 6>{0, 1, 2, 0, 2, 3} : std::array<size_t, 6>{0, 2, 1, 0, 3, 2};
+
+    for(const auto& index : quad)
+        geometry.m_Indices.push_back(first_vertex + index);
+}
+
+bool FaceMerger::canMerge(const Face& a, const Face& b)
+{
+    static const auto epsilon = 1e-4f;
+
+    if(a.m_Winding != b.m_Winding || !a.m_Normal.isApprox(b.m_Normal))
+        return false;
+
+    if(LevelBatcher::materialKey(*a.m_Geometry) != LevelBatcher::materialKey(*b.m_Geometry))
+        return false;
+
+    // same affine texture mapping means the texture continues across the shared edge
+    return (a.m_UvTransform - b.m_UvTransform).cwiseAbs().maxCoeff() < epsilon && (a.m_UvOffset - b.m_UvOffset).cwiseAbs().maxCoeff() < epsilon;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "model/Level.h"
+
+#include "math/Matrix.h"
+
+#include "processor/TrileCuller.h"
+
+#include <map>
+
+class FaceMerger
+{
+    // a side of an emplaced trile that is one full unit quad, in world space
+    struct Face
+    {
+        size_t m_Emplacement = 0;
+        int m_LocalSide = 0;
+        const Geometry* m_Geometry = nullptr;
+        Vec3f m_Center = Vec3f::Zero();
+        Vec3f m_Normal = Vec3f::UnitY();
+        Mat2f m_UvTransform = Mat2f::Identity();
+        Vec2f m_UvOffset = Vec2f::Zero();
+        bool m_Winding = true;
+    };
+
+    using Faces = std::vector<Face>;
+    using FaceResult = std::optional<Face>;
+    using MergedGeometries = std::map<QString, Geometry>;
+
+public:
+    FaceMerger();
+    ~FaceMerger();
+
+    Level merge(const Level& level);
+
+    size_t getMergedFaces() const noexcept;
+
+private:
+    FaceResult extractFace(const TrileEmplacement& emplacement, const Geometry& geometry, const TrileCuller::TrileFaces& faces, const int& side) const;
+    void addQuad(const Face& first, const Face& last, const int& worldSide);
+
+    static bool canMerge(const Face& a, const Face& b);
+
+private:
+    QString m_LevelName;
+    MergedGeometries m_MergedGeometries;
+    size_t m_MergedFaces;
+};
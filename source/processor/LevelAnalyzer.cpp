@@ -0,0 +1,128 @@
+#include "processor/LevelAnalyzer.h"
+
+#include "math/Orientation.h"
+
+#include "processor/LevelBatcher.h"
+
+#include "texture/AlphaClassifier.h"
+
+#include <map>
+
+LevelAnalyzer::LevelAnalyzer(const bool& batch, const bool& countAlpha) : m_Batch{batch}, m_CountAlpha{countAlpha}
+{
+}
+
+LevelAnalysis LevelAnalyzer::analyze(const Level& level)
+{
+    auto result = LevelAnalysis();
+
+    result.m_Batched = m_Batch;
+
+    // baking is the expensive part, it is done once no matter how many formats are written
+    if(m_Batch)
+        result.m_Batches = LevelBatcher().batch(level);
+    else
+        groupInstances(level, result);
+
+    if(m_CountAlpha)
+        classifyAlpha(result);
+
+    return result;
+}
+
+void LevelAnalyzer::groupInstances(const Level& level, LevelAnalysis& analysis)
+{
+    // group everything that shares a mesh, every group becomes one instanced node
+    auto& groups = analysis.m_InstanceGroups;
+
+    for(const auto& ao : level.m_ArtObjects)
+    {
+        const auto ao_geom_find_iter = level.m_ArtObjectGeometries.find(ao.m_Name);
+
+        if(ao_geom_find_iter == level.m_ArtObjectGeometries.cend())
+            continue;
+
+        auto& group = groups["ao:" + ao.m_Name];
+
+        group.m_Name = ao.m_Name;
+        group.m_Geometry = &ao_geom_find_iter->second;
+        group.m_Instances.push_back({ao.m_Position - Vec3f::Constant(0.5f), ao.m_Rotation, ao.m_Scale});
+    }
+
+    for(const auto& te : level.m_TrileEmplacements)
+    {
+        const auto trile_geom_find_iter = level.m_TrileGeometries.find(te.m_Id);
+
+        if(trile_geom_find_iter == level.m_TrileGeometries.cend())
+            continue;
+
+        auto& group = groups["trile:" + QString::number(te.m_Id)];
+
+        group.m_Name = trile_geom_find_iter->second.m_Name;
+        group.m_Geometry = &trile_geom_find_iter->second;
+        group.m_Instances.push_back({te.m_Position, trileOrientation(te.m_Orintation), Vec3f::Ones()});
+    }
+
+    for(const auto& bp : level.m_BackgroundPlanes)
+    {
+        const auto& geometry = bp.m_Geometry;
+        auto& group = groups["plane:" + geometry.m_Name + ":" + LevelBatcher::materialKey(geometry)];
+
+        group.m_Name = bp.m_Name;
+        group.m_Geometry = &geometry;
+        group.m_Instances.push_back({bp.m_Position - Vec3f::Constant(0.5f), bp.m_Rotation, bp.m_Scale});
+    }
+
+    for(const auto& car : level.m_Characters)
+    {
+        auto& group = groups["npc:" + car.m_Geometry.m_Name];
+
+        group.m_Name = car.m_Name;
+        group.m_Geometry = &car.m_Geometry;
+        group.m_Instances.push_back({car.m_Position, QuaternionF::Identity(), Vec3f::Ones()});
+    }
+
+    for(size_t i = 0; i < level.m_BakedGeometries.size(); i++)
+    {
+        const auto& geometry = level.m_BakedGeometries[i];
+        auto& group = groups["baked:" + QString::number(i)];
+
+        group.m_Name = geometry.m_Name;
+        group.m_Geometry = &geometry;
+        group.m_Instances.push_back({Vec3f::Zero(), QuaternionF::Identity(), Vec3f::Ones()});
+    }
+}
+
+void LevelAnalyzer::classifyAlpha(LevelAnalysis& analysis)
+{
+    // many groups share a texture, unknown ones are scanned once per analysis
+    auto alphas = std::map<QString, TextureAlpha>();
+
+    const auto count = [&analysis, &alphas](const Geometry& geometry) -> void {
+        const auto& texture = geometry.m_Texture;
+        auto alpha = texture.m_Alpha;
+
+        if(alpha == TextureAlpha::Unknown)
+        {
+            auto alpha_find_iter = alphas.find(texture.m_TextureOrgFile);
+
+            if(alpha_find_iter == alphas.cend())
+                alpha_find_iter = alphas.insert({texture.m_TextureOrgFile, AlphaClassifier::classify(texture.m_TextureOrgFile)}).first;
+
+            alpha = alpha_find_iter->second;
+        }
+
+        if(alpha == TextureAlpha::Translucent || geometry.m_Opacity < 1.0f)
+            analysis.m_NumTranslucent++;
+        else if(alpha == TextureAlpha::Cutout)
+            analysis.m_NumCutout++;
+        else
+            analysis.m_NumOpaque++;
+    };
+
+    for(const auto& batch : analysis.m_Batches)
+        count(batch);
+
+    for(const auto& group : analysis.m_InstanceGroups)
+        count(*group.second.m_Geometry);
+}
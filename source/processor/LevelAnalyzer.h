@@ -0,0 +1,22 @@
+#pragma once
+
+#include "model/Level.h"
+#include "model/LevelAnalysis.h"
+
+class LevelAnalyzer
+{
+public:
+    // alpha is only counted for the stats backend, the writers look at their own materials
+    LevelAnalyzer(const bool& batch, const bool& countAlpha);
+
+    // the result keeps pointers into level, it must not outlive it
+    LevelAnalysis analyze(const Level& level);
+
+private:
+    void groupInstances(const Level& level, LevelAnalysis& analysis);
+    void classifyAlpha(LevelAnalysis& analysis);
+
+private:
+    bool m_Batch;
+    bool m_CountAlpha;
+};
@@ -0,0 +1,219 @@
+#include "processor/LevelBatcher.h"
+
+#include "math/Orientation.h"
+#include "math/Side.h"
+
+LevelBatcher::LevelBatcher() : m_LevelName{}, m_Batches{}
+{
+}
+
+LevelBatcher::~LevelBatcher()
+{
+}
+
+LevelBatcher::Batches LevelBatcher::batch(const Level& level)
+{
+    m_LevelName = level.m_LevelName;
+    m_Batches.clear();
+
+    batchTriles(level);
+    batchArtObjects(level);
+    batchBackgroundPlanes(level);
+    batchCharacters(level);
+
+    for(const auto& geometry : level.m_BakedGeometries)
+        appendTransformed(geometry, Mat3f::Identity(), Vec3f::Zero());
+
+    Batches result;
+    result.reserve(m_Batches.size());
+
+    for(auto& batch : m_Batches)
+        result.push_back(std::move(batch.second));
+
+    m_Batches.clear();
+
+    return result;
+}
+
+void LevelBatcher::batchTriles(const Level& level)
+{
+    // group emplacements by trile and orientation, every group shares one rotated copy of the trile
+    using GroupKey = std::pair<int, unsigned int>;
+    using Translations = std::vector<Vec3f>;
+
+    std::map<GroupKey, Translations> groups;
+
+    for(const auto& te : level.m_TrileEmplacements)
+    {
+        if(level.m_TrileGeometries.find(te.m_Id) == level.m_TrileGeometries.cend())
+            continue;
+
+        groups[{te.m_Id, te.m_Orintation}].push_back(te.m_Position);
+    }
+
+    for(const auto& group : groups)
+    {
+        const auto& geometry = level.m_TrileGeometries.at(group.first.first);
+        const auto& translations = group.second;
+
+        const auto num_vertices = geometry.m_Vertices.size();
+        const auto num_indices = geometry.m_Indices.size();
+        const auto num_instances = translations.size();
+
+        if(num_vertices == 0 || num_indices == 0)
+            continue;
+
+        // rotate once with the precomputed orientation matrix
+        auto positions = Mat3Xf(3, num_vertices);
+        auto normals = Mat3Xf(3, num_vertices);
+
+        for(size_t i = 0; i < num_vertices; i++)
+        {
+            positions.col(i) = geometry.m_Vertices[i].m_Position;
+            normals.col(i) = geometry.m_Vertices[i].m_Normal;
+        }
+
+        const auto& rotation = trileOrientationMatrix(group.first.second);
+        const Mat3Xf rotated_positions = rotation * positions;
+        const Mat3Xf rotated_normals = rotation * normals;
+
+        // translate the rotated trile for every emplacement of the group
+        auto batch_positions = Mat3Xf(3, num_vertices * num_instances);
+
+        for(size_t k = 0; k < num_instances; k++)
+            batch_positions.middleCols(k * num_vertices, num_vertices) = rotated_positions.colwise() + translations[k];
+
+        auto& batch = getBatch(geometry);
+
+        const auto first_vertex = batch.m_Vertices.size();
+        const auto first_index = batch.m_Indices.size();
+
+        batch.m_Vertices.resize(first_vertex + num_vertices * num_instances);
+        batch.m_Indices.resize(first_index + num_indices * num_instances);
+
+        for(size_t k = 0; k < num_instances; k++)
+        {
+            const auto vertex_offset = first_vertex + k * num_vertices;
+            const auto index_offset = first_index + k * num_indices;
+
+            for(size_t i = 0; i < num_vertices; i++)
+            {
+                auto& vertex = batch.m_Vertices[vertex_offset + i];
+
+                vertex = geometry.m_Vertices[i];
+                vertex.m_Position = batch_positions.col(k * num_vertices + i);
+                vertex.m_Normal = rotated_normals.col(i);
+
+                if(vertex.m_Side >= 0)
+                    vertex.m_Side = sideIndex(vertex.m_Normal);
+            }
+
+            for(size_t i = 0; i < num_indices; i++)
+                batch.m_Indices[index_offset + i] = vertex_offset + geometry.m_Indices[i];
+        }
+    }
+}
+
+void LevelBatcher::batchArtObjects(const Level& level)
+{
+    for(const auto& ao : level.m_ArtObjects)
+    {
+        const auto ao_geom_find_iter = level.m_ArtObjectGeometries.find(ao.m_Name);
+
+        if(ao_geom_find_iter == level.m_ArtObjectGeometries.cend())
+            continue;
+
+        const Mat3f transform = ao.m_Rotation.toRotationMatrix() * ao.m_Scale.asDiagonal();
+
+        appendTransformed(ao_geom_find_iter->second, transform, ao.m_Position - Vec3f::Constant(0.5f));
+    }
+}
+
+void LevelBatcher::batchBackgroundPlanes(const Level& level)
+{
+    for(const auto& bp : level.m_BackgroundPlanes)
+    {
+        const Mat3f transform = bp.m_Rotation.toRotationMatrix() * bp.m_Scale.asDiagonal();
+
+        appendTransformed(bp.m_Geometry, transform, bp.m_Position - Vec3f::Constant(0.5f));
+    }
+}
+
+void LevelBatcher::batchCharacters(const Level& level)
+{
+    for(const auto& car : level.m_Characters)
+        appendTransformed(car.m_Geometry, Mat3f::Identity(), car.m_Position);
+}
+
+Geometry& LevelBatcher::getBatch(const Geometry& geometry)
+{
+    const auto key = materialKey(geometry);
+    const auto batch_find_iter = m_Batches.find(key);
+
+    if(batch_find_iter != m_Batches.cend())
+        return batch_find_iter->second;
+
+    auto batch = Geometry();
+
+    batch.m_Name = m_LevelName + "_" + geometry.m_Texture.m_TextureName;
+    batch.m_Texture = geometry.m_Texture;
+    batch.m_Opacity = geometry.m_Opacity;
+    batch.m_DoubleSided = geometry.m_DoubleSided;
+    batch.m_IsPlane = geometry.m_IsPlane;
+
+    return m_Batches.insert({key, std::move(batch)}).first->second;
+}
+
+void LevelBatcher::appendTransformed(const Geometry& geometry, const Mat3f& transform, const Vec3f& translation)
+{
+    const auto num_vertices = geometry.m_Vertices.size();
+    const auto num_indices = geometry.m_Indices.size();
+
+    if(num_vertices == 0 || num_indices == 0)
+        return;
+
+    auto positions = Mat3Xf(3, num_vertices);
+    auto normals = Mat3Xf(3, num_vertices);
+
+    for(size_t i = 0; i < num_vertices; i++)
+    {
+        positions.col(i) = geometry.m_Vertices[i].m_Position;
+        normals.col(i) = geometry.m_Vertices[i].m_Normal;
+    }
+
+    // normals go with the inverse transpose, non uniform scales would skew them otherwise
+    const auto invertible = std::abs(transform.determinant()) > 1e-8f;
+    const Mat3f normal_transform = invertible ? Mat3f(transform.inverse().transpose()) : transform;
+
+    const Mat3Xf transformed_positions = (transform * positions).colwise() + translation;
+    const Mat3Xf transformed_normals = (normal_transform * normals).colwise().normalized();
+
+    auto& batch = getBatch(geometry);
+
+    const auto first_vertex = batch.m_Vertices.size();
+    const auto first_index = batch.m_Indices.size();
+
+    batch.m_Vertices.resize(first_vertex + num_vertices);
+    batch.m_Indices.resize(first_index + num_indices);
+
+    for(size_t i = 0; i < num_vertices; i++)
+    {
+        auto& vertex = batch.m_Vertices[first_vertex + i];
+
+        vertex = geometry.m_Vertices[i];
+        vertex.m_Position = transformed_positions.col(i);
+        vertex.m_Normal = transformed_normals.col(i);
+
+        if(vertex.m_Side >= 0)
+            vertex.m_Side = sideIndex(vertex.m_Normal);
+    }
+
+    for(size_t i = 0; i < num_indices; i++)
+        batch.m_Indices[first_index + i] = first_vertex + geometry.m_Indices[i];
+}
+
+QString LevelBatcher::materialKey(const Geometry& geometry)
+{
+    return geometry.m_Texture.m_TextureName + ":" + QString::number(geometry.m_Opacity) + ":" + QString::number(geometry.m_DoubleSided) + ":" +
+           QString::number(geometry.m_IsPlane);
+}
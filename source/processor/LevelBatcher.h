@@ -0,0 +1,37 @@
+#pragma once
+
+#include "model/Geometry.h"
+#include "model/Level.h"
+
+#include "math/Matrix.h"
+
+#include <QtCore/QString>
+
+#include <map>
+
+class LevelBatcher
+{
+    using Batches = std::vector<Geometry>;
+    using BatchMap = std::map<QString, Geometry>;
+
+public:
+    LevelBatcher();
+    ~LevelBatcher();
+
+    Batches batch(const Level& level);
+
+    static QString materialKey(const Geometry& geometry);
+
+private:
+    void batchTriles(const Level& level);
+    void batchArtObjects(const Level& level);
+    void batchBackgroundPlanes(const Level& level);
+    void batchCharacters(const Level& level);
+
+    Geometry& getBatch(const Geometry& geometry);
+    void appendTransformed(const Geometry& geometry, const Mat3f& transform, const Vec3f& translation);
+
+private:
+    QString m_LevelName;
+    BatchMap m_Batches;
+};
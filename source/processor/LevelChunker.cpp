@@ -0,0 +1,219 @@
+#include "processor/LevelChunker.h"
+
+#include "math/Orientation.h"
+
+#include <algorithm>
+#include <cmath>
+
+LevelChunker::LevelChunker(const int& chunkSize) : m_ChunkSize{std::max(chunkSize, 1)}, m_LevelName{}, m_TrileSetName{}, m_Chunks{}
+{
+}
+
+LevelChunker::~LevelChunker()
+{
+}
+
+LevelChunker::Chunks LevelChunker::chunk(const Level& level)
+{
+    m_LevelName = level.m_LevelName;
+    m_TrileSetName = level.m_TrileSetName;
+    m_Chunks.clear();
+
+    chunkTriles(level);
+    chunkArtObjects(level);
+    chunkBackgroundPlanes(level);
+    chunkCharacters(level);
+    chunkBakedGeometries(level);
+
+    // morton codes relative to the smallest cell, neighbouring chunks end up close in the list
+    auto min_cell = Vec3i::Constant(std::numeric_limits<int>::max()).eval();
+
+    for(const auto& chunk : m_Chunks)
+        min_cell = min_cell.cwiseMin(chunk.second.m_Cell);
+
+    Chunks result;
+    result.reserve(m_Chunks.size());
+
+    for(auto& chunk : m_Chunks)
+    {
+        chunk.second.m_MortonCode = mortonCode(chunk.second.m_Cell - min_cell);
+        result.push_back(std::move(chunk.second));
+    }
+
+    m_Chunks.clear();
+
+    std::sort(result.begin(), result.end(), [](const Chunk& a, const Chunk& b) { return a.m_MortonCode < b.m_MortonCode; });
+
+    return result;
+}
+
+const int& LevelChunker::getChunkSize() const noexcept
+{
+    return m_ChunkSize;
+}
+
+uint64_t LevelChunker::mortonCode(const Vec3i& cell) noexcept
+{
+    // spread the lower 21 bits of a coordinate to every third bit
+    const auto spread = [](const int& value) -> uint64_t {
+        auto x = uint64_t(value) & 0x1fffff;
+
+        x = (x | x << 32) & 0x1f00000000ffff;
+        x = (x | x << 16) & 0x1f0000ff0000ff;
+        x = (x | x << 8) & 0x100f00f00f00f00f;
+        x = (x | x << 4) & 0x10c30c30c30c30c3;
+        x = (x | x << 2) & 0x1249249249249249;
+
+        return x;
+    };
+
+    return spread(cell.x()) | spread(cell.y()) << 1 | spread(cell.z()) << 2;
+}
+
+void LevelChunker::chunkTriles(const Level& level)
+{
+    for(const auto& te : level.m_TrileEmplacements)
+    {
+        const auto trile_geom_find_iter = level.m_TrileGeometries.find(te.m_Id);
+
+        if(trile_geom_find_iter == level.m_TrileGeometries.cend())
+            continue;
+
+        auto& chunk = getChunk(te.m_Position);
+
+        chunk.m_Level.m_TrileEmplacements.push_back(te);
+        chunk.m_Level.m_TrileGeometries.insert(*trile_geom_find_iter);
+
+        extendBounds(chunk, trile_geom_find_iter->second, trileOrientationMatrix(te.m_Orintation), te.m_Position);
+    }
+}
+
+void LevelChunker::chunkArtObjects(const Level& level)
+{
+    for(const auto& ao : level.m_ArtObjects)
+    {
+        const auto ao_geom_find_iter = level.m_ArtObjectGeometries.find(ao.m_Name);
+
+        if(ao_geom_find_iter == level.m_ArtObjectGeometries.cend())
+            continue;
+
+        auto& chunk = getChunk(ao.m_Position);
+
+        chunk.m_Level.m_ArtObjects.push_back(ao);
+        chunk.m_Level.m_ArtObjectGeometries.insert(*ao_geom_find_iter);
+
+        const Mat3f transform = ao.m_Rotation.toRotationMatrix() * ao.m_Scale.asDiagonal();
+
+        extendBounds(chunk, ao_geom_find_iter->second, transform, ao.m_Position - Vec3f::Constant(0.5f));
+    }
+}
+
+void LevelChunker::chunkBackgroundPlanes(const Level& level)
+{
+    for(const auto& bp : level.m_BackgroundPlanes)
+    {
+        auto& chunk = getChunk(bp.m_Position);
+
+        chunk.m_Level.m_BackgroundPlanes.push_back(bp);
+
+        const Mat3f transform = bp.m_Rotation.toRotationMatrix() * bp.m_Scale.asDiagonal();
+
+        extendBounds(chunk, bp.m_Geometry, transform, bp.m_Position - Vec3f::Constant(0.5f));
+    }
+}
+
+void LevelChunker::chunkCharacters(const Level& level)
+{
+    for(const auto& car : level.m_Characters)
+    {
+        auto& chunk = getChunk(car.m_Position);
+
+        chunk.m_Level.m_Characters.push_back(car);
+
+        extendBounds(chunk, car.m_Geometry, Mat3f::Identity(), car.m_Position);
+    }
+}
+
+void LevelChunker::chunkBakedGeometries(const Level& level)
+{
+    // baked geometry is world space and may span chunks, split it by triangle centroid
+    for(const auto& geometry : level.m_BakedGeometries)
+    {
+        std::map<CellKey, std::pair<Geometry, std::map<size_t, size_t>>> parts;
+
+        for(size_t i = 0; i + 2 < geometry.m_Indices.size(); i += 3)
+        {
+            const Vec3f centroid = (geometry.m_Vertices[geometry.m_Indices[i + 0]].m_Position + geometry.m_Vertices[geometry.m_Indices[i + 1]].m_Position +
+                                    geometry.m_Vertices[geometry.m_Indices[i + 2]].m_Position) /
+                                   3.0f;
+
+            const auto& chunk = getChunk(centroid);
+            auto& part = parts[{chunk.m_Cell.x(), chunk.m_Cell.y(), chunk.m_Cell.z()}];
+            auto& part_geometry = part.first;
+            auto& remap = part.second;
+
+            for(size_t k = 0; k < 3; k++)
+            {
+                const auto index = geometry.m_Indices[i + k];
+                const auto remap_find_iter = remap.find(index);
+
+                if(remap_find_iter != remap.cend())
+                {
+                    part_geometry.m_Indices.push_back(remap_find_iter->second);
+                    continue;
+                }
+
+                remap.insert({index, part_geometry.m_Vertices.size()});
+                part_geometry.m_Indices.push_back(part_geometry.m_Vertices.size());
+                part_geometry.m_Vertices.push_back(geometry.m_Vertices[index]);
+            }
+        }
+
+        for(auto& part : parts)
+        {
+            auto& chunk = m_Chunks.at(part.first);
+            auto& part_geometry = part.second.first;
+
+            part_geometry.m_Name = geometry.m_Name;
+            part_geometry.m_Texture = geometry.m_Texture;
+            part_geometry.m_Opacity = geometry.m_Opacity;
+            part_geometry.m_DoubleSided = geometry.m_DoubleSided;
+            part_geometry.m_IsPlane = geometry.m_IsPlane;
+
+            extendBounds(chunk, part_geometry, Mat3f::Identity(), Vec3f::Zero());
+
+            chunk.m_Level.m_BakedGeometries.push_back(std::move(part_geometry));
+        }
+    }
+}
+
+LevelChunker::Chunk& LevelChunker::getChunk(const Vec3f& anchor)
+{
+    const auto size = float(m_ChunkSize);
+    const auto cell = Vec3i(int(std::floor(anchor.x() / size)), int(std::floor(anchor.y() / size)), int(std::floor(anchor.z() / size)));
+    const auto key = CellKey{cell.x(), cell.y(), cell.z()};
+
+    const auto chunk_find_iter = m_Chunks.find(key);
+
+    if(chunk_find_iter != m_Chunks.cend())
+        return chunk_find_iter->second;
+
+    auto chunk = Chunk();
+
+    chunk.m_Cell = cell;
+    chunk.m_Level.m_LevelName = m_LevelName + "_" + QString::number(cell.x()) + "_" + QString::number(cell.y()) + "_" + QString::number(cell.z());
+    chunk.m_Level.m_TrileSetName = m_TrileSetName;
+
+    return m_Chunks.insert({key, std::move(chunk)}).first->second;
+}
+
+void LevelChunker::extendBounds(Chunk& chunk, const Geometry& geometry, const Mat3f& transform, const Vec3f& translation)
+{
+    for(const auto& vertex : geometry.m_Vertices)
+    {
+        const Vec3f position = transform * vertex.m_Position + translation;
+
+        chunk.m_Min = chunk.m_Min.cwiseMin(position);
+        chunk.m_Max = chunk.m_Max.cwiseMax(position);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "model/Level.h"
+#include "model/Lod.h"
+
+#include "math/Matrix.h"
+#include "math/Vector.h"
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <tuple>
+
+class LevelChunker
+{
+public:
+    // a fixed size cell of the level grid with everything anchored inside it
+    struct Chunk
+    {
+        Vec3i m_Cell = Vec3i::Zero();
+        uint64_t m_MortonCode = 0;
+        Vec3f m_Min = Vec3f::Constant(std::numeric_limits<float>::max());
+        Vec3f m_Max = Vec3f::Constant(std::numeric_limits<float>::lowest());
+        Level m_Level = {};
+        Lods m_Lods = {};
+    };
+
+    using Chunks = std::vector<Chunk>;
+
+private:
+    using CellKey = std::tuple<int, int, int>;
+    using ChunkMap = std::map<CellKey, Chunk>;
+
+public:
+    LevelChunker(const int& chunkSize);
+    ~LevelChunker();
+
+    Chunks chunk(const Level& level);
+
+    const int& getChunkSize() const noexcept;
+
+    static uint64_t mortonCode(const Vec3i& cell) noexcept;
+
+private:
+    void chunkTriles(const Level& level);
+    void chunkArtObjects(const Level& level);
+    void chunkBackgroundPlanes(const Level& level);
+    void chunkCharacters(const Level& level);
+    void chunkBakedGeometries(const Level& level);
+
+    Chunk& getChunk(const Vec3f& anchor);
+
+    static void extendBounds(Chunk& chunk, const Geometry& geometry, const Mat3f& transform, const Vec3f& translation);
+
+private:
+    int m_ChunkSize;
+    QString m_LevelName;
+    QString m_TrileSetName;
+    ChunkMap m_Chunks;
+};
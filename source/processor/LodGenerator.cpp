@@ -0,0 +1,56 @@
+#include "processor/LodGenerator.h"
+
+#include "processor/MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+
+LodGenerator::LodGenerator(const int& numLods) : m_NumLods{std::clamp(numLods, 0, 4)}
+{
+}
+
+LodGenerator::~LodGenerator()
+{
+}
+
+Lods LodGenerator::generate(const QString& name, const Geometries& geometries) const
+{
+    Lods result;
+
+    auto previous_triangles = size_t(0);
+
+    for(const auto& geometry : geometries)
+        previous_triangles += geometry.m_Indices.size() / 3;
+
+    for(int level = 1; level <= m_NumLods; level++)
+    {
+        const auto ratio = std::ldexp(1.0, -level);
+        const auto suffix = "_lod" + QString::number(level);
+
+        auto lod = Lod();
+        lod.m_Name = name + suffix;
+
+        // simplify from full detail, the error stays relative to the original geometry
+        for(const auto& geometry : geometries)
+        {
+            const auto target = size_t(std::ceil(double(geometry.m_Indices.size() / 3) * ratio));
+
+            MeshSimplifier simplifier;
+            auto simplified = simplifier.simplify(geometry, target);
+
+            simplified.m_Name = geometry.m_Name + suffix;
+
+            lod.m_Triangles += simplified.m_Indices.size() / 3;
+            lod.m_Error = std::max(lod.m_Error, simplifier.getError());
+            lod.m_Geometries.push_back(std::move(simplified));
+        }
+
+        if(lod.m_Triangles >= previous_triangles)
+            break;
+
+        previous_triangles = lod.m_Triangles;
+        result.push_back(std::move(lod));
+    }
+
+    return result;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "model/Geometry.h"
+#include "model/Lod.h"
+
+#include <QtCore/QString>
+
+class LodGenerator
+{
+    using Geometries = std::vector<Geometry>;
+
+public:
+    LodGenerator(const int& numLods);
+    ~LodGenerator();
+
+    // every lod halves the triangle count of the one before, lods that do not reduce further are dropped
+    Lods generate(const QString& name, const Geometries& geometries) const;
+
+private:
+    int m_NumLods;
+};
@@ -0,0 +1,248 @@
+#include "processor/MeshDeduplicator.h"
+
+#include "model/GeometryHash.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutexLocker>
+
+#include <optional>
+#include <type_traits>
+
+QMutex MeshDeduplicator::sm_ReportMutex = {};
+MeshDeduplicator::Report MeshDeduplicator::sm_Report = {};
+
+namespace
+{
+    constexpr uint64_t fnv_offset = 14695981039346656037ull;
+    constexpr uint64_t fnv_prime = 1099511628211ull;
+
+    template<typename Key>
+    QString aliasName(const Key& key)
+    {
+        if constexpr(std::is_same_v<Key, QString>)
+            return key;
+        else
+            return QString::number(key);
+    }
+
+    // aliases of one category share the report, the scope keeps keys of different sets and levels apart
+    template<typename Key>
+    QString aliasName(const QString& scope, const Key& key)
+    {
+        return scope.isEmpty() ? aliasName(key) : scope + ":" + aliasName(key);
+    }
+}
+
+MeshDeduplicator::MeshDeduplicator(const QString& category) : m_Category{category}, m_TextureHashes{}
+{
+}
+
+MeshDeduplicator::~MeshDeduplicator()
+{
+}
+
+MeshDeduplicator::TrileAliases MeshDeduplicator::dedupe(Level::TrileGeometries& triles, const QString& setName)
+{
+    return collapse(triles, setName);
+}
+
+MeshDeduplicator::NameAliases MeshDeduplicator::dedupe(Level::ArtObjectGeometries& artObjects)
+{
+    // art object names are unique over the whole content
+    return collapse(artObjects, {});
+}
+
+Level MeshDeduplicator::dedupe(const Level& level)
+{
+    auto result = level;
+
+    const auto trile_aliases = collapse(result.m_TrileGeometries, level.m_LevelName);
+    const auto art_object_aliases = collapse(result.m_ArtObjectGeometries, level.m_LevelName);
+
+    for(auto& te : result.m_TrileEmplacements)
+    {
+        const auto alias_find_iter = trile_aliases.find(te.m_Id);
+
+        if(alias_find_iter != trile_aliases.cend())
+            te.m_Id = alias_find_iter->second;
+    }
+
+    for(auto& ao : result.m_ArtObjects)
+    {
+        const auto alias_find_iter = art_object_aliases.find(ao.m_Name);
+
+        if(alias_find_iter != art_object_aliases.cend())
+            ao.m_Name = alias_find_iter->second;
+    }
+
+    return result;
+}
+
+template<typename Key>
+std::map<Key, Key> MeshDeduplicator::collapse(std::map<Key, Geometry>& geometries, const QString& scope)
+{
+    // candidates by content hash, keys are visited in order so the smallest key of a group is kept
+    std::multimap<uint64_t, Key> kept;
+    std::map<Key, Key> result;
+
+    auto savings = Savings();
+
+    for(const auto& entry : geometries)
+    {
+        const auto& geometry = entry.second;
+        const auto content_hash = geometry.m_Hash != 0 ? geometry.m_Hash : geometryHash(geometry);
+        const auto candidates = kept.equal_range(content_hash);
+
+        auto original = std::optional<Key>();
+
+        for(auto candidate = candidates.first; candidate != candidates.second; candidate++)
+        {
+            const auto& other = geometries.at(candidate->second);
+
+            if(sameMaterial(geometry, other) && equal(geometry, other))
+            {
+                original = candidate->second;
+                break;
+            }
+        }
+
+        if(!original)
+        {
+            kept.insert({content_hash, entry.first});
+            continue;
+        }
+
+        result.insert({entry.first, *original});
+
+        savings.m_Meshes++;
+        savings.m_Bytes += geometry.m_Vertices.size() * sizeof(Vertex) + geometry.m_Indices.size() * sizeof(size_t);
+        savings.m_Aliases.insert({aliasName(scope, entry.first), aliasName(*original)});
+    }
+
+    for(const auto& alias : result)
+        geometries.erase(alias.first);
+
+    if(savings.m_Meshes == 0)
+        return result;
+
+    QMutexLocker locker(&sm_ReportMutex);
+
+    auto& report = sm_Report[m_Category];
+
+    report.m_Meshes += savings.m_Meshes;
+    report.m_Bytes += savings.m_Bytes;
+    report.m_Aliases.merge(savings.m_Aliases);
+
+    return result;
+}
+
+bool MeshDeduplicator::equal(const Geometry& lhs, const Geometry& rhs)
+{
+    if(lhs.m_Vertices.size() != rhs.m_Vertices.size() || lhs.m_Indices != rhs.m_Indices)
+        return false;
+
+    for(size_t i = 0; i < lhs.m_Vertices.size(); i++)
+    {
+        const auto& l = lhs.m_Vertices[i];
+        const auto& r = rhs.m_Vertices[i];
+
+        if(l.m_Position != r.m_Position || l.m_Normal != r.m_Normal || l.m_TextureCoordinate != r.m_TextureCoordinate || l.m_Side != r.m_Side)
+            return false;
+    }
+
+    return true;
+}
+
+bool MeshDeduplicator::sameMaterial(const Geometry& lhs, const Geometry& rhs)
+{
+    if(lhs.m_Opacity != rhs.m_Opacity || lhs.m_DoubleSided != rhs.m_DoubleSided || lhs.m_IsPlane != rhs.m_IsPlane)
+        return false;
+
+    const auto& lhs_texture = lhs.m_Texture;
+    const auto& rhs_texture = rhs.m_Texture;
+
+    if(lhs_texture.m_TextureName == rhs_texture.m_TextureName)
+        return true;
+
+    // art objects carry their own texture file, copies of one object only match by content
+    if(lhs_texture.m_IsAnimated || rhs_texture.m_IsAnimated || lhs_texture.m_Width != rhs_texture.m_Width || lhs_texture.m_Height != rhs_texture.m_Height)
+        return false;
+
+    const auto lhs_hash = textureHash(lhs_texture);
+
+    return lhs_hash != 0 && lhs_hash == textureHash(rhs_texture);
+}
+
+uint64_t MeshDeduplicator::textureHash(const Texture& texture)
+{
+    const auto hash_find_iter = m_TextureHashes.find(texture.m_TextureOrgFile);
+
+    if(hash_find_iter != m_TextureHashes.cend())
+        return hash_find_iter->second;
+
+    auto result = uint64_t(0);
+
+    QFile file(texture.m_TextureOrgFile);
+
+    if(file.open(QIODevice::OpenModeFlag::ReadOnly))
+    {
+        const auto data = file.readAll();
+        const auto bytes = reinterpret_cast<const uint8_t*>(data.constData());
+
+        result = fnv_offset;
+
+        for(qsizetype i = 0; i < data.size(); i++)
+            result = (result ^ bytes[i]) * fnv_prime;
+
+        file.close();
+    }
+
+    m_TextureHashes.insert({texture.m_TextureOrgFile, result});
+
+    return result;
+}
+
+void MeshDeduplicator::writeReport(const QString& path)
+{
+    QMutexLocker locker(&sm_ReportMutex);
+
+    auto categories = QJsonObject();
+    auto total_meshes = size_t(0);
+    auto total_bytes = size_t(0);
+
+    for(const auto& category : sm_Report)
+    {
+        const auto& savings = category.second;
+
+        auto aliases = QJsonObject();
+
+        for(const auto& alias : savings.m_Aliases)
+            aliases.insert(alias.first, alias.second);
+
+        categories.insert(category.first,
+                          QJsonObject{{"meshes", qint64(savings.m_Meshes)}, {"bytesSaved", qint64(savings.m_Bytes)}, {"aliases", aliases}});
+
+        total_meshes += savings.m_Meshes;
+        total_bytes += savings.m_Bytes;
+
+        qDebug() << "Deduplicated: " << category.first << savings.m_Meshes << "meshes," << savings.m_Bytes << "bytes saved";
+    }
+
+    const auto report = QJsonObject{{"meshes", qint64(total_meshes)}, {"bytesSaved", qint64(total_bytes)}, {"categories", categories}};
+
+    QDir dir(path);
+
+    if(!dir.exists())
+        dir.mkpath(".");
+
+    QFile file(path + "/dedupe_report.json");
+
+    if(!file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return;
+
+    file.write(QJsonDocument(report).toJson(QJsonDocument::JsonFormat::Indented));
+    file.close();
+}
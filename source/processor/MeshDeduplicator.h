@@ -0,0 +1,60 @@
+#pragma once
+
+#include "model/Geometry.h"
+#include "model/Level.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <map>
+
+class MeshDeduplicator
+{
+public:
+    using TrileAliases = std::map<int, int>;
+    using NameAliases = std::map<QString, QString>;
+
+private:
+    using TextureHashes = std::map<QString, uint64_t>;
+
+    struct Savings
+    {
+        size_t m_Meshes = 0;
+        size_t m_Bytes = 0;
+        NameAliases m_Aliases = {};
+    };
+
+    using Report = std::map<QString, Savings>;
+
+public:
+    // category names the line of the report the savings go to
+    MeshDeduplicator(const QString& category);
+    ~MeshDeduplicator();
+
+    // keeps the first of every group of identical meshes, returns the key every dropped mesh now points at
+    // trile ids repeat between sets, their report aliases are qualified with the set name as set:key
+    TrileAliases dedupe(Level::TrileGeometries& triles, const QString& setName);
+    NameAliases dedupe(Level::ArtObjectGeometries& artObjects);
+
+    // emplacements and art objects are redirected to the kept mesh, report aliases are qualified as level:key
+    Level dedupe(const Level& level);
+
+    static bool equal(const Geometry& lhs, const Geometry& rhs);
+
+    // dedupe_report.json with meshes and bytes saved per category
+    static void writeReport(const QString& path);
+
+private:
+    template<typename Key>
+    std::map<Key, Key> collapse(std::map<Key, Geometry>& geometries, const QString& scope);
+
+    bool sameMaterial(const Geometry& lhs, const Geometry& rhs);
+    uint64_t textureHash(const Texture& texture);
+
+private:
+    QString m_Category;
+    TextureHashes m_TextureHashes;
+
+    static QMutex sm_ReportMutex;
+    static Report sm_Report;
+};
@@ -0,0 +1,328 @@
+#include "processor/MeshOptimizer.h"
+
+#include <qdebug.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+    // exact bit pattern of a vertex, -0 and +0 compare equal
+    using VertexKey = std::array<uint32_t, 9>;
+
+    struct VertexKeyHash
+    {
+        size_t operator()(const VertexKey& key) const noexcept
+        {
+            auto result = uint64_t(14695981039346656037ull);
+
+            for(const auto& value : key)
+                result = (result ^ value) * 1099511628211ull;
+
+            return size_t(result);
+        }
+    };
+
+    VertexKey vertexKey(const Vertex& vertex)
+    {
+        const auto values = std::array<float, 8>{vertex.m_Position.x(),
+                                                 vertex.m_Position.y(),
+                                                 vertex.m_Position.z(),
+                                                 vertex.m_Normal.x(),
+                                                 vertex.m_Normal.y(),
+                                                 vertex.m_Normal.z(),
+                                                 vertex.m_TextureCoordinate.x(),
+                                                 vertex.m_TextureCoordinate.y()};
+
+        auto result = VertexKey();
+
+        for(size_t i = 0; i < values.size(); i++)
+        {
+            const auto value = values[i] == 0.0f ? 0.0f : values[i];
+            std::memcpy(&result[i], &value, sizeof(float));
+        }
+
+        result[8] = uint32_t(vertex.m_Side);
+
+        return result;
+    }
+
+    // forsyth, linear speed vertex cache optimisation
+    constexpr auto cache_size = 32;
+    constexpr auto cache_decay_power = 1.5f;
+    constexpr auto last_triangle_score = 0.75f;
+    constexpr auto valence_boost_scale = 2.0f;
+    constexpr auto valence_boost_power = 0.5f;
+
+    float vertexScore(const int& cachePosition, const int& remainingTriangles)
+    {
+        if(remainingTriangles == 0)
+            return -1.0f;
+
+        auto score = 0.0f;
+
+        if(cachePosition >= 0)
+        {
+            if(cachePosition < 3)
+                score = last_triangle_score;
+            else
+                score = std::pow(1.0f - float(cachePosition - 3) / float(cache_size - 3), cache_decay_power);
+        }
+
+        return score + valence_boost_scale * std::pow(float(remainingTriangles), -valence_boost_power);
+    }
+}
+
+MeshOptimizer::MeshOptimizer() : m_WeldedVertices{0}, m_RemovedTriangles{0}
+{
+}
+
+MeshOptimizer::~MeshOptimizer()
+{
+}
+
+Geometry MeshOptimizer::optimize(const Geometry& geometry)
+{
+    auto result = weld(geometry);
+
+    result.m_Indices = optimizeVertexCache(result.m_Indices, result.m_Vertices.size());
+
+    return optimizeVertexFetch(result);
+}
+
+Level MeshOptimizer::optimize(const Level& level)
+{
+    m_WeldedVertices = 0;
+    m_RemovedTriangles = 0;
+
+    auto result = level;
+
+    for(auto& trile : result.m_TrileGeometries)
+        trile.second = optimize(trile.second);
+
+    for(auto& ao : result.m_ArtObjectGeometries)
+        ao.second = optimize(ao.second);
+
+    for(auto& bp : result.m_BackgroundPlanes)
+        bp.m_Geometry = optimize(bp.m_Geometry);
+
+    for(auto& car : result.m_Characters)
+        car.m_Geometry = optimize(car.m_Geometry);
+
+    for(auto& geometry : result.m_BakedGeometries)
+        geometry = optimize(geometry);
+
+    qDebug() << "optimized: " << m_WeldedVertices << " welded vertices, " << m_RemovedTriangles << " degenerate triangles in " << level.m_LevelName;
+
+    return result;
+}
+
+size_t MeshOptimizer::getWeldedVertices() const noexcept
+{
+    return m_WeldedVertices;
+}
+
+size_t MeshOptimizer::getRemovedTriangles() const noexcept
+{
+    return m_RemovedTriangles;
+}
+
+Geometry MeshOptimizer::weld(const Geometry& geometry)
+{
+    auto result = geometry;
+    result.m_Vertices.clear();
+    result.m_Indices.clear();
+
+    std::unordered_map<VertexKey, size_t, VertexKeyHash> welded;
+    welded.reserve(geometry.m_Vertices.size());
+
+    auto remap = Indices(geometry.m_Vertices.size());
+
+    for(size_t i = 0; i < geometry.m_Vertices.size(); i++)
+    {
+        const auto& vertex = geometry.m_Vertices[i];
+        const auto insert_result = welded.insert({vertexKey(vertex), result.m_Vertices.size()});
+
+        if(insert_result.second)
+            result.m_Vertices.push_back(vertex);
+
+        remap[i] = insert_result.first->second;
+    }
+
+    m_WeldedVertices += geometry.m_Vertices.size() - result.m_Vertices.size();
+
+    // drop triangles that collapsed to a line or a point, unused vertices go with the fetch reorder
+    result.m_Indices.reserve(geometry.m_Indices.size());
+
+    for(size_t i = 0; i + 2 < geometry.m_Indices.size(); i += 3)
+    {
+        const auto a = remap[geometry.m_Indices[i + 0]];
+        const auto b = remap[geometry.m_Indices[i + 1]];
+        const auto c = remap[geometry.m_Indices[i + 2]];
+
+        const auto& pa = result.m_Vertices[a].m_Position;
+        const auto& pb = result.m_Vertices[b].m_Position;
+        const auto& pc = result.m_Vertices[c].m_Position;
+
+        if(a == b || b == c || a == c || (pb - pa).cross(pc - pa).squaredNorm() == 0.0f)
+        {
+            m_RemovedTriangles++;
+            continue;
+        }
+
+        result.m_Indices.push_back(a);
+        result.m_Indices.push_back(b);
+        result.m_Indices.push_back(c);
+    }
+
+    return result;
+}
+
+MeshOptimizer::Indices MeshOptimizer::optimizeVertexCache(const Indices& indices, const size_t& numVertices)
+{
+    const auto num_triangles = indices.size() / 3;
+
+    if(num_triangles == 0)
+        return indices;
+
+    // triangles per vertex
+    auto offsets = std::vector<size_t>(numVertices + 1, 0);
+
+    for(const auto& index : indices)
+        offsets[index + 1]++;
+
+    for(size_t v = 0; v < numVertices; v++)
+        offsets[v + 1] += offsets[v];
+
+    auto vertex_triangles = std::vector<size_t>(indices.size());
+    auto fill = std::vector<size_t>(offsets.cbegin(), offsets.cend() - 1);
+
+    for(size_t t = 0; t < num_triangles; t++)
+        for(size_t k = 0; k < 3; k++)
+            vertex_triangles[fill[indices[3 * t + k]]++] = t;
+
+    auto remaining = std::vector<int>(numVertices);
+    auto cache_position = std::vector<int>(numVertices, -1);
+    auto vertex_scores = std::vector<float>(numVertices);
+
+    for(size_t v = 0; v < numVertices; v++)
+    {
+        remaining[v] = int(offsets[v + 1] - offsets[v]);
+        vertex_scores[v] = vertexScore(-1, remaining[v]);
+    }
+
+    auto emitted = std::vector<bool>(num_triangles, false);
+
+    auto cache = std::vector<size_t>();
+    cache.reserve(cache_size + 3);
+
+    Indices result;
+    result.reserve(indices.size());
+
+    auto best_triangle = std::numeric_limits<size_t>::max();
+    auto scan_cursor = size_t(0);
+
+    for(size_t emitted_count = 0; emitted_count < num_triangles; emitted_count++)
+    {
+        // nothing good around the cache, continue with the first triangle left
+        if(best_triangle == std::numeric_limits<size_t>::max())
+        {
+            while(emitted[scan_cursor])
+                scan_cursor++;
+
+            best_triangle = scan_cursor;
+        }
+
+        emitted[best_triangle] = true;
+
+        auto new_cache = std::vector<size_t>();
+        new_cache.reserve(cache_size + 3);
+
+        for(size_t k = 0; k < 3; k++)
+        {
+            const auto v = indices[3 * best_triangle + k];
+
+            result.push_back(v);
+            new_cache.push_back(v);
+
+            remaining[v]--;
+
+            // remove the emitted triangle from the vertex list
+            const auto begin = vertex_triangles.begin() + offsets[v];
+            const auto end = begin + remaining[v] + 1;
+            std::iter_swap(std::find(begin, end, best_triangle), end - 1);
+        }
+
+        for(const auto& v : cache)
+            if(std::find(new_cache.cbegin(), new_cache.cend(), v) == new_cache.cend())
+                new_cache.push_back(v);
+
+        // vertices pushed out of the cache lose their position score
+        for(size_t i = cache_size; i < new_cache.size(); i++)
+        {
+            const auto& v = new_cache[i];
+
+            cache_position[v] = -1;
+            vertex_scores[v] = vertexScore(-1, remaining[v]);
+        }
+
+        new_cache.resize(std::min(new_cache.size(), size_t(cache_size)));
+        cache = std::move(new_cache);
+
+        for(size_t i = 0; i < cache.size(); i++)
+        {
+            const auto& v = cache[i];
+
+            cache_position[v] = int(i);
+            vertex_scores[v] = vertexScore(int(i), remaining[v]);
+        }
+
+        // rescore the triangles around the cache and pick the best one
+        best_triangle = std::numeric_limits<size_t>::max();
+        auto best_score = -1.0f;
+
+        for(const auto& v : cache)
+        {
+            for(int i = 0; i < remaining[v]; i++)
+            {
+                const auto& t = vertex_triangles[offsets[v] + i];
+                const auto score = vertex_scores[indices[3 * t + 0]] + vertex_scores[indices[3 * t + 1]] + vertex_scores[indices[3 * t + 2]];
+
+                if(score > best_score)
+                {
+                    best_score = score;
+                    best_triangle = t;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+Geometry MeshOptimizer::optimizeVertexFetch(const Geometry& geometry)
+{
+    // vertices in order of first use, unused vertices are dropped
+    auto result = geometry;
+    result.m_Vertices.clear();
+    result.m_Vertices.reserve(geometry.m_Vertices.size());
+
+    auto remap = Indices(geometry.m_Vertices.size(), std::numeric_limits<size_t>::max());
+
+    for(auto& index : result.m_Indices)
+    {
+        if(remap[index] == std::numeric_limits<size_t>::max())
+        {
+            remap[index] = result.m_Vertices.size();
+            result.m_Vertices.push_back(geometry.m_Vertices[index]);
+        }
+
+        index = remap[index];
+    }
+
+    return result;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "model/Geometry.h"
+#include "model/Level.h"
+
+class MeshOptimizer
+{
+    using Indices = Geometry::Indices;
+
+public:
+    MeshOptimizer();
+    ~MeshOptimizer();
+
+    // weld, drop degenerates, reorder for the post transform cache and for vertex fetch
+    Geometry optimize(const Geometry& geometry);
+    Level optimize(const Level& level);
+
+    size_t getWeldedVertices() const noexcept;
+    size_t getRemovedTriangles() const noexcept;
+
+private:
+    Geometry weld(const Geometry& geometry);
+
+    static Indices optimizeVertexCache(const Indices& indices, const size_t& numVertices);
+    static Geometry optimizeVertexFetch(const Geometry& geometry);
+
+private:
+    size_t m_WeldedVertices;
+    size_t m_RemovedTriangles;
+};
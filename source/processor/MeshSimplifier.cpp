@@ -0,0 +1,232 @@
+#include "processor/MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <queue>
+#include <tuple>
+
+MeshSimplifier::MeshSimplifier() : m_Error{0.0f}
+{
+}
+
+MeshSimplifier::~MeshSimplifier()
+{
+}
+
+Geometry MeshSimplifier::simplify(const Geometry& geometry, const size_t& targetTriangles)
+{
+    m_Error = 0.0f;
+
+    const auto& vertices = geometry.m_Vertices;
+    const auto num_vertices = vertices.size();
+    const auto num_triangles = geometry.m_Indices.size() / 3;
+
+    if(num_triangles <= targetTriangles)
+        return geometry;
+
+    const auto position = [&vertices](const size_t& v) -> Eigen::Vector3d { return vertices[v].m_Position.cast<double>(); };
+
+    const auto face_normal = [&position](const Triangle& t) -> Eigen::Vector3d {
+        return (position(t[1]) - position(t[0])).cross(position(t[2]) - position(t[0]));
+    };
+
+    // plane quadrics per vertex
+    auto triangles = std::vector<Triangle>(num_triangles);
+    auto removed = std::vector<bool>(num_triangles, false);
+    auto vertex_triangles = std::vector<std::vector<size_t>>(num_vertices);
+    auto quadrics = std::vector<Quadric>(num_vertices, Quadric::Zero());
+
+    for(size_t i = 0; i < num_triangles; i++)
+    {
+        auto& t = triangles[i];
+        t = {geometry.m_Indices[3 * i + 0], geometry.m_Indices[3 * i + 1], geometry.m_Indices[3 * i + 2]};
+
+        for(const auto& v : t)
+            vertex_triangles[v].push_back(i);
+
+        const auto n = face_normal(t);
+        const auto length = n.norm();
+
+        if(length < 1e-12)
+            continue;
+
+        auto plane = Eigen::Vector4d();
+        plane << n / length, -(n / length).dot(position(t[0]));
+
+        const Quadric q = plane * plane.transpose();
+
+        for(const auto& v : t)
+            quadrics[v] += q;
+    }
+
+    // vertices on open borders and seams never move
+    auto locked = std::vector<bool>(num_vertices, false);
+    std::map<std::pair<size_t, size_t>, int> edges;
+
+    for(const auto& t : triangles)
+        for(size_t k = 0; k < 3; k++)
+            edges[std::minmax(t[k], t[(k + 1) % 3])]++;
+
+    for(const auto& edge : edges)
+    {
+        if(edge.second != 1)
+            continue;
+
+        locked[edge.first.first] = true;
+        locked[edge.first.second] = true;
+    }
+
+    // a position used by several vertices splits texture coordinates, normals or sides
+    std::map<std::tuple<float, float, float>, size_t> positions;
+
+    for(size_t v = 0; v < num_vertices; v++)
+    {
+        const auto& p = vertices[v].m_Position;
+        const auto key = std::make_tuple(p.x(), p.y(), p.z());
+        const auto position_find_iter = positions.find(key);
+
+        if(position_find_iter == positions.cend())
+        {
+            positions.insert({key, v});
+            continue;
+        }
+
+        locked[v] = true;
+        locked[position_find_iter->second] = true;
+    }
+
+    auto collapsed = std::vector<bool>(num_vertices, false);
+    auto versions = std::vector<unsigned int>(num_vertices, 0);
+    auto candidates = std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>>();
+
+    const auto push_collapse = [&](const size_t& from, const size_t& to) -> void {
+        if(locked[from] || vertices[from].m_Side != vertices[to].m_Side)
+            return;
+
+        auto p = Eigen::Vector4d();
+        p << position(to), 1.0;
+
+        const auto cost = std::max(p.dot((quadrics[from] + quadrics[to]) * p), 0.0);
+
+        candidates.push({cost, from, to, versions[from], versions[to]});
+    };
+
+    for(const auto& edge : edges)
+    {
+        push_collapse(edge.first.first, edge.first.second);
+        push_collapse(edge.first.second, edge.first.first);
+    }
+
+    auto remaining = num_triangles;
+    auto max_cost = 0.0;
+
+    while(remaining > targetTriangles && !candidates.empty())
+    {
+        const auto candidate = candidates.top();
+        candidates.pop();
+
+        const auto& from = candidate.m_From;
+        const auto& to = candidate.m_To;
+
+        if(collapsed[from] || collapsed[to] || versions[from] != candidate.m_FromVersion || versions[to] != candidate.m_ToVersion)
+            continue;
+
+        // reject collapses that flip or degenerate a remaining triangle
+        auto valid = true;
+
+        for(const auto& t : vertex_triangles[from])
+        {
+            if(removed[t] || std::find(triangles[t].cbegin(), triangles[t].cend(), to) != triangles[t].cend())
+                continue;
+
+            auto moved = triangles[t];
+            std::replace(moved.begin(), moved.end(), from, to);
+
+            const auto old_normal = face_normal(triangles[t]);
+            const auto new_normal = face_normal(moved);
+
+            if(new_normal.squaredNorm() < 1e-12 || new_normal.dot(old_normal) <= 0.0)
+            {
+                valid = false;
+                break;
+            }
+        }
+
+        if(!valid)
+            continue;
+
+        for(const auto& t : vertex_triangles[from])
+        {
+            if(removed[t])
+                continue;
+
+            auto& triangle = triangles[t];
+
+            if(std::find(triangle.cbegin(), triangle.cend(), to) != triangle.cend())
+            {
+                removed[t] = true;
+                remaining--;
+                continue;
+            }
+
+            std::replace(triangle.begin(), triangle.end(), from, to);
+            vertex_triangles[to].push_back(t);
+        }
+
+        quadrics[to] += quadrics[from];
+        collapsed[from] = true;
+        versions[to]++;
+        max_cost = std::max(max_cost, candidate.m_Cost);
+
+        // costs around the surviving vertex changed
+        for(const auto& t : vertex_triangles[to])
+        {
+            if(removed[t])
+                continue;
+
+            for(const auto& v : triangles[t])
+            {
+                if(v == to)
+                    continue;
+
+                push_collapse(v, to);
+                push_collapse(to, v);
+            }
+        }
+    }
+
+    m_Error = float(std::sqrt(max_cost));
+
+    // compact the remaining triangles
+    auto result = geometry;
+    result.m_Vertices.clear();
+    result.m_Indices.clear();
+
+    auto remap = std::vector<size_t>(num_vertices, std::numeric_limits<size_t>::max());
+
+    for(size_t i = 0; i < num_triangles; i++)
+    {
+        if(removed[i])
+            continue;
+
+        for(const auto& v : triangles[i])
+        {
+            if(remap[v] == std::numeric_limits<size_t>::max())
+            {
+                remap[v] = result.m_Vertices.size();
+                result.m_Vertices.push_back(vertices[v]);
+            }
+
+            result.m_Indices.push_back(remap[v]);
+        }
+    }
+
+    return result;
+}
+
+const float& MeshSimplifier::getError() const noexcept
+{
+    return m_Error;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "model/Geometry.h"
+
+#include <Eigen/Dense>
+
+class MeshSimplifier
+{
+    using Quadric = Eigen::Matrix<double, 4, 4>;
+    using Triangle = std::array<size_t, 3>;
+
+    struct Collapse
+    {
+        double m_Cost = 0.0;
+        size_t m_From = 0;
+        size_t m_To = 0;
+        unsigned int m_FromVersion = 0;
+        unsigned int m_ToVersion = 0;
+
+        bool operator>(const Collapse& other) const noexcept { return m_Cost > other.m_Cost; }
+    };
+
+public:
+    MeshSimplifier();
+    ~MeshSimplifier();
+
+    // quadric edge collapse onto existing vertices, uv seams, side borders and open borders stay fixed
+    Geometry simplify(const Geometry& geometry, const size_t& targetTriangles);
+
+    const float& getError() const noexcept;
+
+private:
+    float m_Error;
+};
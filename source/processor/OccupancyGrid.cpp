@@ -0,0 +1,76 @@
+#include "processor/OccupancyGrid.h"
+
+#include <cmath>
+#include <limits>
+
+OccupancyGrid::OccupancyGrid(const Level& level) : m_Min{Vec3i::Zero()}, m_Size{Vec3i::Zero()}, m_Cells{}
+{
+    const auto& emplacements = level.m_TrileEmplacements;
+
+    // bounds of all emplacements that have geometry
+    auto min = Vec3i::Constant(std::numeric_limits<int>::max()).eval();
+    auto max = Vec3i::Constant(std::numeric_limits<int>::min()).eval();
+
+    for(const auto& te : emplacements)
+    {
+        if(level.m_TrileGeometries.find(te.m_Id) == level.m_TrileGeometries.cend())
+            continue;
+
+        const auto c = cell(te);
+
+        min = min.cwiseMin(c);
+        max = max.cwiseMax(c);
+    }
+
+    if((max.array() < min.array()).any())
+        return;
+
+    m_Min = min;
+    m_Size = max - min + Vec3i::Ones();
+    m_Cells = std::vector<int>(size_t(m_Size.x()) * size_t(m_Size.y()) * size_t(m_Size.z()), -1);
+
+    for(size_t i = 0; i < emplacements.size(); i++)
+    {
+        const auto& te = emplacements[i];
+
+        if(level.m_TrileGeometries.find(te.m_Id) == level.m_TrileGeometries.cend())
+            continue;
+
+        const auto c = cell(te) - m_Min;
+        auto& entry = m_Cells[(size_t(c.z()) * m_Size.y() + c.y()) * m_Size.x() + c.x()];
+
+        if(entry == -1)
+            entry = int(i);
+    }
+}
+
+OccupancyGrid::~OccupancyGrid()
+{
+}
+
+int OccupancyGrid::at(const Vec3i& cell) const noexcept
+{
+    const auto c = (cell - m_Min).eval();
+
+    if((c.array() < 0).any() || (c.array() >= m_Size.array()).any())
+        return -1;
+
+    return m_Cells[(size_t(c.z()) * m_Size.y() + c.y()) * m_Size.x() + c.x()];
+}
+
+const Vec3i& OccupancyGrid::getMin() const noexcept
+{
+    return m_Min;
+}
+
+const Vec3i& OccupancyGrid::getSize() const noexcept
+{
+    return m_Size;
+}
+
+Vec3i OccupancyGrid::cell(const TrileEmplacement& emplacement) noexcept
+{
+    const auto& e = emplacement.m_Emplacement;
+
+    return {int(std::lround(e.x())), int(std::lround(e.y())), int(std::lround(e.z()))};
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "model/Level.h"
+
+#include "math/Vector.h"
+
+class OccupancyGrid
+{
+public:
+    OccupancyGrid(const Level& level);
+    ~OccupancyGrid();
+
+    int at(const Vec3i& cell) const noexcept;
+
+    const Vec3i& getMin() const noexcept;
+    const Vec3i& getSize() const noexcept;
+
+    static Vec3i cell(const TrileEmplacement& emplacement) noexcept;
+
+private:
+    Vec3i m_Min;
+    Vec3i m_Size;
+
+    // emplacement index per cell, -1 for empty cells
+    std::vector<int> m_Cells;
+};
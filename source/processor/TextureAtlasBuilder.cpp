@@ -0,0 +1,233 @@
+#include "processor/TextureAtlasBuilder.h"
+
+#include "texture/AlphaClassifier.h"
+#include "texture/ImageCache.h"
+#include "texture/SkylinePacker.h"
+
+#include <QtCore/QDir>
+
+#include <qdebug.h>
+
+#include <algorithm>
+#include <numeric>
+
+TextureAtlasBuilder::TextureAtlasBuilder(const QString& path, const int& atlasSize, const int& padding)
+    : m_Path{path}, m_AtlasSize{atlasSize}, m_Padding{std::max(padding, 0)}, m_Entries{}, m_EntryIds{}, m_Atlases{}
+{
+}
+
+TextureAtlasBuilder::~TextureAtlasBuilder()
+{
+}
+
+Level TextureAtlasBuilder::build(const Level& level)
+{
+    m_Entries.clear();
+    m_EntryIds.clear();
+    m_Atlases.clear();
+
+    for(const auto& bp : level.m_BackgroundPlanes)
+        addTexture(bp.m_Geometry.m_Texture);
+
+    for(const auto& car : level.m_Characters)
+        addTexture(car.m_Geometry.m_Texture);
+
+    // a single texture gains nothing from an atlas
+    if(m_Entries.size() < 2)
+        return level;
+
+    const auto num_atlases = pack();
+
+    QDir dir(m_Path);
+
+    if(!dir.exists())
+        dir.mkpath(".");
+
+    for(int i = 0; i < num_atlases; i++)
+        writeAtlas(i, level.m_LevelName + "_atlas_" + QString::number(i) + ".png");
+
+    auto result = level;
+
+    for(auto& bp : result.m_BackgroundPlanes)
+        remap(bp.m_Geometry);
+
+    for(auto& car : result.m_Characters)
+        remap(car.m_Geometry);
+
+    qDebug() << "atlas: " << m_Entries.size() << " textures into " << m_Atlases.size() << " atlases in " << level.m_LevelName;
+
+    return result;
+}
+
+size_t TextureAtlasBuilder::getNumAtlases() const noexcept
+{
+    return m_Atlases.size();
+}
+
+void TextureAtlasBuilder::addTexture(const Texture& texture)
+{
+    if(texture.m_TextureOrgFile.isEmpty() || m_EntryIds.find(texture.m_TextureOrgFile) != m_EntryIds.cend())
+        return;
+
+    // animated sheets keep their own file, the frame offsets are relative to it
+    if(texture.m_IsAnimated)
+        return;
+
+    auto entry = Entry();
+
+    entry.m_File = texture.m_TextureOrgFile;
+    entry.m_Image = ImageCache::image(texture.m_TextureOrgFile);
+    entry.m_Alpha = texture.m_Alpha;
+
+    if(entry.m_Image.isNull())
+        return;
+
+    if(entry.m_Alpha == TextureAlpha::Unknown)
+        entry.m_Alpha = AlphaClassifier::classify(entry.m_Image);
+
+    m_EntryIds.insert({entry.m_File, m_Entries.size()});
+    m_Entries.push_back(std::move(entry));
+}
+
+int TextureAtlasBuilder::pack()
+{
+    // tall textures first keep the skyline flat
+    auto order = std::vector<size_t>(m_Entries.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+
+    std::sort(order.begin(), order.end(), [this](const size_t& a, const size_t& b) {
+        const auto& image_a = m_Entries[a].m_Image;
+        const auto& image_b = m_Entries[b].m_Image;
+
+        return image_a.height() != image_b.height() ? image_a.height() > image_b.height() : image_a.width() > image_b.width();
+    });
+
+    // every atlas holds one alpha class, otherwise one translucent texture makes all of them blend
+    auto class_sizes = std::map<TextureAlpha, size_t>();
+
+    for(const auto& entry : m_Entries)
+        class_sizes[entry.m_Alpha]++;
+
+    std::vector<SkylinePacker> packers;
+    std::vector<TextureAlpha> packer_alphas;
+
+    for(const auto& i : order)
+    {
+        auto& entry = m_Entries[i];
+
+        // a single texture gains nothing from an atlas
+        if(class_sizes[entry.m_Alpha] < 2)
+            continue;
+
+        const auto width = entry.m_Image.width() + 2 * m_Padding;
+        const auto height = entry.m_Image.height() + 2 * m_Padding;
+
+        // textures larger than an atlas keep their own file
+        if(width > m_AtlasSize || height > m_AtlasSize)
+            continue;
+
+        for(int atlas = 0; atlas <= int(packers.size()) && entry.m_Atlas < 0; atlas++)
+        {
+            if(atlas == int(packers.size()))
+            {
+                packers.emplace_back(m_AtlasSize, m_AtlasSize);
+                packer_alphas.push_back(entry.m_Alpha);
+            }
+
+            if(packer_alphas[atlas] != entry.m_Alpha)
+                continue;
+
+            const auto position = packers[atlas].insert(width, height);
+
+            if(!position)
+                continue;
+
+            entry.m_Atlas = atlas;
+            entry.m_Rect = QRect(position->x() + m_Padding, position->y() + m_Padding, entry.m_Image.width(), entry.m_Image.height());
+        }
+    }
+
+    return int(packers.size());
+}
+
+void TextureAtlasBuilder::writeAtlas(const int& atlas, const QString& name)
+{
+    auto width = 1;
+    auto height = 1;
+    auto alpha = TextureAlpha::Opaque;
+
+    for(const auto& entry : m_Entries)
+    {
+        if(entry.m_Atlas != atlas)
+            continue;
+
+        width = std::max(width, entry.m_Rect.x() + entry.m_Rect.width() + m_Padding);
+        height = std::max(height, entry.m_Rect.y() + entry.m_Rect.height() + m_Padding);
+        alpha = std::max(alpha, entry.m_Alpha);
+    }
+
+    auto image = QImage(width, height, QImage::Format::Format_ARGB32);
+    image.fill(0);
+
+    for(const auto& entry : m_Entries)
+    {
+        if(entry.m_Atlas != atlas)
+            continue;
+
+        const auto source = entry.m_Image.format() == QImage::Format::Format_ARGB32 ? entry.m_Image : entry.m_Image.convertToFormat(QImage::Format::Format_ARGB32);
+
+        const auto source_width = source.width();
+        const auto source_height = source.height();
+
+        // the padding repeats the border pixels so filtering never reaches a neighbour
+        for(int y = -m_Padding; y < source_height + m_Padding; y++)
+        {
+            const auto source_line = reinterpret_cast<const uint32_t*>(source.constScanLine(std::clamp(y, 0, source_height - 1)));
+            const auto target_line = reinterpret_cast<uint32_t*>(image.scanLine(entry.m_Rect.y() + y));
+
+            for(int x = -m_Padding; x < source_width + m_Padding; x++)
+                target_line[entry.m_Rect.x() + x] = source_line[std::clamp(x, 0, source_width - 1)];
+        }
+    }
+
+    auto texture = Texture();
+
+    texture.m_TextureName = name;
+    texture.m_TextureOrgFile = m_Path + "/" + name;
+    texture.m_Width = (unsigned int)width;
+    texture.m_Height = (unsigned int)height;
+    texture.m_Alpha = alpha;
+
+    image.save(texture.m_TextureOrgFile);
+
+    m_Atlases.push_back(texture);
+}
+
+void TextureAtlasBuilder::remap(Geometry& geometry) const
+{
+    const auto entry_find_iter = m_EntryIds.find(geometry.m_Texture.m_TextureOrgFile);
+
+    if(entry_find_iter == m_EntryIds.cend())
+        return;
+
+    const auto& entry = m_Entries[entry_find_iter->second];
+
+    if(entry.m_Atlas < 0)
+        return;
+
+    const auto& atlas = m_Atlases[entry.m_Atlas];
+
+    const auto offset = Vec2f{float(entry.m_Rect.x()) / float(atlas.m_Width), float(entry.m_Rect.y()) / float(atlas.m_Height)};
+    const auto scale = Vec2f{float(entry.m_Rect.width()) / float(atlas.m_Width), float(entry.m_Rect.height()) / float(atlas.m_Height)};
+
+    // texture coordinates are stored with v flipped, the atlas rectangles are top down
+    for(auto& vertex : geometry.m_Vertices)
+    {
+        auto& uv = vertex.m_TextureCoordinate;
+
+        uv.x() = offset.x() + uv.x() * scale.x();
+        uv.y() = 1.0f - (offset.y() + (1.0f - uv.y()) * scale.y());
+    }
+
+    geometry.m_Texture = atlas;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "model/Level.h"
+
+#include <QtCore/QRect>
+#include <QtCore/QString>
+
+#include <QtGui/QImage>
+
+#include <map>
+
+class TextureAtlasBuilder
+{
+    // a source texture and where it ended up, the rectangle excludes the padding
+    struct Entry
+    {
+        QString m_File = {};
+        QImage m_Image = {};
+        TextureAlpha m_Alpha = TextureAlpha::Unknown;
+        int m_Atlas = -1;
+        QRect m_Rect = {};
+    };
+
+    using Entries = std::vector<Entry>;
+    using EntryIds = std::map<QString, size_t>;
+    using Atlases = std::vector<Texture>;
+
+public:
+    TextureAtlasBuilder(const QString& path, const int& atlasSize = 2048, const int& padding = 2);
+    ~TextureAtlasBuilder();
+
+    // packs static background plane and character textures, atlases are saved to the export path
+    Level build(const Level& level);
+
+    size_t getNumAtlases() const noexcept;
+
+private:
+    void addTexture(const Texture& texture);
+    int pack();
+    void writeAtlas(const int& atlas, const QString& name);
+    void remap(Geometry& geometry) const;
+
+private:
+    QString m_Path;
+    int m_AtlasSize;
+    int m_Padding;
+
+    Entries m_Entries;
+    EntryIds m_EntryIds;
+    Atlases m_Atlases;
+};
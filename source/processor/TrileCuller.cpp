@@ -0,0 +1,271 @@
+#include "processor/TrileCuller.h"
+
+#include "math/Orientation.h"
+#include "math/Side.h"
+
+#include "texture/AlphaClassifier.h"
+
+#include <qdebug.h>
+
+#include <limits>
+
+TrileCuller::TrileCuller() : m_TrileFaces{}, m_CulledTriangles{0}
+{
+}
+
+TrileCuller::~TrileCuller()
+{
+}
+
+Level TrileCuller::cull(const Level& level)
+{
+    classifyTriles(level);
+
+    const auto grid = OccupancyGrid(level);
+
+    auto hidden_sides = SideMasks(level.m_TrileEmplacements.size(), 0);
+
+    for(size_t i = 0; i < level.m_TrileEmplacements.size(); i++)
+    {
+        const auto& te = level.m_TrileEmplacements[i];
+
+        if(m_TrileFaces.find(te.m_Id) != m_TrileFaces.cend())
+            hidden_sides[i] = hiddenSides(level, grid, te);
+    }
+
+    auto result = removeSides(level, hidden_sides);
+
+    qDebug() << "culled: " << m_CulledTriangles << " triangles in " << level.m_LevelName;
+
+    return result;
+}
+
+Level TrileCuller::removeSides(const Level& level, const SideMasks& sides)
+{
+    classifyTriles(level);
+
+    m_CulledTriangles = 0;
+
+    auto result = level;
+    auto next_id = level.m_TrileGeometries.empty() ? 0 : level.m_TrileGeometries.crbegin()->first + 1;
+
+    Variants variants;
+    Level::TrileEmplacements emplacements;
+    emplacements.reserve(level.m_TrileEmplacements.size());
+
+    for(size_t i = 0; i < level.m_TrileEmplacements.size(); i++)
+    {
+        const auto& te = level.m_TrileEmplacements[i];
+        const auto faces_find_iter = m_TrileFaces.find(te.m_Id);
+
+        if(faces_find_iter == m_TrileFaces.cend())
+        {
+            emplacements.push_back(te);
+            continue;
+        }
+
+        const auto& hidden_sides = sides[i];
+
+        if(hidden_sides == 0)
+        {
+            emplacements.push_back(te);
+            continue;
+        }
+
+        // every trile / hidden side combination becomes its own trile geometry
+        const auto& geometry = level.m_TrileGeometries.at(te.m_Id);
+        const auto key = VariantKey(te.m_Id, hidden_sides);
+
+        auto variant_find_iter = variants.find(key);
+
+        if(variant_find_iter == variants.cend())
+        {
+            auto variant = removeSides(geometry, faces_find_iter->second, hidden_sides);
+            auto variant_id = std::optional<int>();
+
+            if(!variant.m_Indices.empty())
+            {
+                variant_id = next_id++;
+                result.m_TrileGeometries.insert({*variant_id, std::move(variant)});
+            }
+
+            variant_find_iter = variants.insert({key, variant_id}).first;
+        }
+
+        const auto& variant_id = variant_find_iter->second;
+        const auto culled_indices = geometry.m_Indices.size() - (variant_id ? result.m_TrileGeometries.at(*variant_id).m_Indices.size() : 0);
+
+        m_CulledTriangles += culled_indices / 3;
+
+        // completely enclosed
+        if(!variant_id)
+            continue;
+
+        auto culled_te = te;
+        culled_te.m_Id = *variant_id;
+
+        emplacements.push_back(culled_te);
+    }
+
+    result.m_TrileEmplacements = std::move(emplacements);
+
+    return result;
+}
+
+size_t TrileCuller::getCulledTriangles() const noexcept
+{
+    return m_CulledTriangles;
+}
+
+void TrileCuller::classifyTriles(const Level& level)
+{
+    m_TrileFaces.clear();
+
+    // the triles of a set share one texture, it is classified once
+    auto alphas = TextureAlphas();
+
+    for(const auto& trile : level.m_TrileGeometries)
+    {
+        const auto& geometry = trile.second;
+        const auto& texture = geometry.m_Texture;
+
+        auto alpha = texture.m_Alpha;
+
+        if(alpha == TextureAlpha::Unknown)
+        {
+            auto alpha_find_iter = alphas.find(texture.m_TextureOrgFile);
+
+            if(alpha_find_iter == alphas.cend())
+                alpha_find_iter = alphas.insert({texture.m_TextureOrgFile, AlphaClassifier::classify(texture.m_TextureOrgFile)}).first;
+
+            alpha = alpha_find_iter->second;
+        }
+
+        auto faces = classify(geometry);
+
+        // grates, fences and glass are closed but must not hide their neighbors
+        if(alpha == TextureAlpha::Opaque && geometry.m_Opacity >= 1.0f)
+            faces.m_Occludes = faces.m_Covered;
+
+        m_TrileFaces.insert({trile.first, std::move(faces)});
+    }
+}
+
+unsigned int TrileCuller::hiddenSides(const Level& level, const OccupancyGrid& grid, const TrileEmplacement& emplacement) const
+{
+    const auto& faces = m_TrileFaces.at(emplacement.m_Id);
+    const auto cell = OccupancyGrid::cell(emplacement);
+    const auto& rotation = trileOrientationMatrix(emplacement.m_Orintation);
+
+    auto result = 0u;
+
+    for(int side = 0; side < 6; side++)
+    {
+        if(!faces.m_HasSide[side])
+            continue;
+
+        // neighbor in the direction of the side
+        const Vec3f direction = rotation * sideNormal(side);
+        const Vec3i offset = direction.array().round().cast<int>();
+
+        const auto neighbor_index = grid.at(cell + offset);
+
+        if(neighbor_index < 0)
+            continue;
+
+        const auto& neighbor = level.m_TrileEmplacements[neighbor_index];
+        const auto neighbor_faces_find_iter = m_TrileFaces.find(neighbor.m_Id);
+
+        if(neighbor_faces_find_iter == m_TrileFaces.cend())
+            continue;
+
+        // side of the neighbor that faces this trile
+        const Vec3f neighbor_direction = trileOrientationMatrix(neighbor.m_Orintation).transpose() * -direction;
+
+        if(neighbor_faces_find_iter->second.m_Occludes[sideIndex(neighbor_direction)])
+            result |= 1u << side;
+    }
+
+    return result;
+}
+
+TrileCuller::TrileFaces TrileCuller::classify(const Geometry& geometry)
+{
+    static const auto half_extent = 0.5f;
+    static const auto epsilon = 1e-4f;
+
+    const auto num_faces = geometry.m_Indices.size() / 3;
+
+    TrileFaces result;
+    result.m_TriangleSides = std::vector<int>(num_faces, -1);
+
+    auto side_areas = std::array<float, 6>{};
+
+    for(size_t i = 0; i < num_faces; i++)
+    {
+        const auto& v0 = geometry.m_Vertices[geometry.m_Indices[3 * i + 0]];
+        const auto& v1 = geometry.m_Vertices[geometry.m_Indices[3 * i + 1]];
+        const auto& v2 = geometry.m_Vertices[geometry.m_Indices[3 * i + 2]];
+
+        if(v0.m_Side < 0)
+            continue;
+
+        // the side index gives the axis, the face has to lie on the trile boundary along it
+        const auto axis = v0.m_Side % 3;
+        const auto c = v0.m_Position[axis];
+
+        if(std::abs(v1.m_Position[axis] - c) > epsilon || std::abs(v2.m_Position[axis] - c) > epsilon)
+            continue;
+
+        if(std::abs(std::abs(c) - half_extent) > epsilon)
+            continue;
+
+        const auto side = c < 0.0f ? axis : axis + 3;
+        const auto area = 0.5f * (v1.m_Position - v0.m_Position).cross(v2.m_Position - v0.m_Position).norm();
+
+        result.m_TriangleSides[i] = side;
+        result.m_HasSide[side] = true;
+
+        side_areas[side] += area;
+    }
+
+    // a side is closed if its boundary triangles cover the whole unit square
+    for(int side = 0; side < 6; side++)
+        result.m_Covered[side] = side_areas[side] >= 1.0f - 1e-3f;
+
+    return result;
+}
+
+Geometry TrileCuller::removeSides(const Geometry& geometry, const TrileFaces& faces, const unsigned int& sides)
+{
+    auto result = geometry;
+    result.m_Name = geometry.m_Name + "_" + QString::number(sides);
+    result.m_Vertices.clear();
+    result.m_Indices.clear();
+
+    // keep the remaining triangles and only the vertices they use
+    auto remap = std::vector<size_t>(geometry.m_Vertices.size(), std::numeric_limits<size_t>::max());
+
+    for(size_t i = 0; i < faces.m_TriangleSides.size(); i++)
+    {
+        const auto& side = faces.m_TriangleSides[i];
+
+        if(side >= 0 && (sides & (1u << side)) != 0)
+            continue;
+
+        for(int c = 0; c < 3; c++)
+        {
+            const auto index = geometry.m_Indices[3 * i + c];
+
+            if(remap[index] == std::numeric_limits<size_t>::max())
+            {
+                remap[index] = result.m_Vertices.size();
+                result.m_Vertices.push_back(geometry.m_Vertices[index]);
+            }
+
+            result.m_Indices.push_back(remap[index]);
+        }
+    }
+
+    return result;
+}
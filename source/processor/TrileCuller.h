@@ -0,0 +1,52 @@
+#pragma once
+
+#include "model/Level.h"
+
+#include "processor/OccupancyGrid.h"
+
+#include <array>
+#include <map>
+
+class TrileCuller
+{
+public:
+    // boundary side per triangle (-1 for triangles inside the trile), which trile sides are completely closed
+    // and which of those hide what is behind them, see-through textures and opacity below 1 do not
+    struct TrileFaces
+    {
+        std::vector<int> m_TriangleSides = {};
+        std::array<bool, 6> m_HasSide = {};
+        std::array<bool, 6> m_Covered = {};
+        std::array<bool, 6> m_Occludes = {};
+    };
+
+    // bit mask of local trile sides per emplacement
+    using SideMasks = std::vector<unsigned int>;
+
+private:
+    using TrileFacesMap = std::map<int, TrileFaces>;
+    using TextureAlphas = std::map<QString, TextureAlpha>;
+    using VariantKey = std::pair<int, unsigned int>;
+    using Variants = std::map<VariantKey, std::optional<int>>;
+
+public:
+    TrileCuller();
+    ~TrileCuller();
+
+    Level cull(const Level& level);
+    Level removeSides(const Level& level, const SideMasks& sides);
+
+    size_t getCulledTriangles() const noexcept;
+
+    static TrileFaces classify(const Geometry& geometry);
+
+private:
+    void classifyTriles(const Level& level);
+    unsigned int hiddenSides(const Level& level, const OccupancyGrid& grid, const TrileEmplacement& emplacement) const;
+
+    static Geometry removeSides(const Geometry& geometry, const TrileFaces& faces, const unsigned int& sides);
+
+private:
+    TrileFacesMap m_TrileFaces;
+    size_t m_CulledTriangles;
+};
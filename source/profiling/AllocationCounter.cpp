@@ -0,0 +1,122 @@
+#include "profiling/AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+std::array<std::atomic<quint64>, size_t(ProfileStage::Count)> AllocationCounter::sm_Allocations = {};
+std::array<std::atomic<quint64>, size_t(ProfileStage::Count)> AllocationCounter::sm_Bytes = {};
+
+namespace
+{
+    // constant initialized, safe to read from operator new before main
+    thread_local auto current_stage = ProfileStage::Other;
+}
+
+bool AllocationCounter::isAvailable()
+{
+#ifdef FMG_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+ProfileStage AllocationCounter::enter(const ProfileStage& stage)
+{
+    const auto previous = current_stage;
+    current_stage = stage;
+
+    return previous;
+}
+
+void AllocationCounter::leave(const ProfileStage& previous)
+{
+    current_stage = previous;
+}
+
+void AllocationCounter::count(const size_t& bytes)
+{
+    const auto stage = size_t(current_stage);
+
+    sm_Allocations[stage].fetch_add(1, std::memory_order_relaxed);
+    sm_Bytes[stage].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+AllocationCounter::StageCounts AllocationCounter::counts()
+{
+    auto result = StageCounts();
+
+    for(size_t i = 0; i < result.size(); i++)
+        result[i] = {sm_Allocations[i].load(std::memory_order_relaxed), sm_Bytes[i].load(std::memory_order_relaxed)};
+
+    return result;
+}
+
+// diagnostic build only, every new in the process goes through the counter
+#ifdef FMG_COUNT_ALLOCATIONS
+namespace
+{
+    void* countedAllocate(const std::size_t& size) noexcept
+    {
+        AllocationCounter::count(size);
+
+        return std::malloc(size == 0 ? 1 : size);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    if(auto result = countedAllocate(size))
+        return result;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if(auto result = countedAllocate(size))
+        return result;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+#endif
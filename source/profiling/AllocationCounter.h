@@ -0,0 +1,33 @@
+#pragma once
+
+#include "profiling/CounterProfiler.h"
+
+#include <array>
+#include <atomic>
+
+// heap allocations per stage, only a build with FMG_COUNT_ALLOCATIONS replaces the global operator new
+class AllocationCounter
+{
+public:
+    struct Counts
+    {
+        quint64 m_Allocations = 0;
+        quint64 m_Bytes = 0;
+    };
+
+    using StageCounts = std::array<Counts, size_t(ProfileStage::Count)>;
+
+public:
+    static bool isAvailable();
+
+    // stage of the calling thread, enter returns the one to restore on leave
+    static ProfileStage enter(const ProfileStage& stage);
+    static void leave(const ProfileStage& previous);
+
+    static void count(const size_t& bytes);
+    static StageCounts counts();
+
+private:
+    static std::array<std::atomic<quint64>, size_t(ProfileStage::Count)> sm_Allocations;
+    static std::array<std::atomic<quint64>, size_t(ProfileStage::Count)> sm_Bytes;
+};
@@ -0,0 +1,236 @@
+#include "profiling/CounterProfiler.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QString>
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+std::atomic<bool> CounterProfiler::sm_Enabled = false;
+
+QMutex CounterProfiler::sm_ThreadsMutex = {};
+CounterProfiler::Threads CounterProfiler::sm_Threads = {};
+
+namespace
+{
+    const auto stage_names = std::array<const char*, size_t(ProfileStage::Count)>{"other", "parse", "cache lookup", "scene build", "export", "texture copy"};
+
+    // cpu time of the calling thread, time blocked on cache locks and futures does not count
+    qint64 nanoseconds()
+    {
+#ifdef _WIN32
+        FILETIME creation_time, exit_time, kernel_time, user_time;
+
+        if(!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+            return 0;
+
+        const auto ticks = [](const FILETIME& time) -> qint64 { return qint64(time.dwHighDateTime) << 32 | qint64(time.dwLowDateTime); };
+
+        // 100 ns ticks
+        return (ticks(kernel_time) + ticks(user_time)) * 100;
+#else
+        timespec time;
+
+        if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+            return 0;
+
+        return qint64(time.tv_sec) * 1000000000 + qint64(time.tv_nsec);
+#endif
+    }
+
+#ifdef __linux__
+    // user space only, so it works with the default perf_event_paranoid
+    int openCounter(const quint32& type, const quint64& config, const int& groupFd)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = groupFd == -1 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+#endif
+}
+
+void CounterProfiler::start()
+{
+    sm_Enabled.store(true, std::memory_order_relaxed);
+}
+
+const char* CounterProfiler::stageName(const ProfileStage& stage)
+{
+    return stage_names[size_t(stage)];
+}
+
+void CounterProfiler::open(ThreadCounters& counters)
+{
+#ifdef __linux__
+    static constexpr auto configs = std::array<quint64, NumCounters>{PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+    for(const auto& config : configs)
+    {
+        const auto fd = openCounter(PERF_TYPE_HARDWARE, config, counters.m_GroupFd);
+
+        // a missing counter (virtual machines, containers) drops the whole group, times are still kept
+        if(fd == -1)
+        {
+            for(const auto& open_fd : counters.m_Fds)
+                close(open_fd);
+
+            counters.m_Fds.clear();
+            counters.m_GroupFd = -1;
+
+            return;
+        }
+
+        counters.m_Fds.push_back(fd);
+
+        if(counters.m_GroupFd == -1)
+            counters.m_GroupFd = fd;
+    }
+
+    ioctl(counters.m_GroupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters.m_GroupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+    Q_UNUSED(counters);
+#endif
+}
+
+CounterProfiler::ThreadCounters& CounterProfiler::threadCounters()
+{
+    // the counters outlive pool threads, their totals are read at the end of the run
+    thread_local ThreadCounters* thread_counters = nullptr;
+
+    if(thread_counters)
+        return *thread_counters;
+
+    {
+        QMutexLocker locker(&sm_ThreadsMutex);
+
+        sm_Threads.push_back(std::make_unique<ThreadCounters>());
+        thread_counters = sm_Threads.back().get();
+    }
+
+    open(*thread_counters);
+
+    return *thread_counters;
+}
+
+CounterProfiler::Sample CounterProfiler::sample(const ThreadCounters& counters)
+{
+    auto result = Sample();
+
+#ifdef __linux__
+    if(counters.m_GroupFd != -1)
+    {
+        // PERF_FORMAT_GROUP, the number of counters followed by their values
+        auto values = std::array<quint64, NumCounters + 1>();
+
+        if(read(counters.m_GroupFd, values.data(), sizeof(values)) == ssize_t(sizeof(values)))
+            std::copy(values.cbegin() + 1, values.cend(), result.m_Counters.begin());
+    }
+#endif
+
+    result.m_Nanoseconds = nanoseconds();
+
+    return result;
+}
+
+void CounterProfiler::flush(ThreadCounters& counters)
+{
+    const auto now = sample(counters);
+
+    if(!counters.m_Stack.empty())
+    {
+        auto& stage = counters.m_Stages[size_t(counters.m_Stack.back())];
+
+        for(size_t i = 0; i < NumCounters; i++)
+            stage.m_Counters[i] += now.m_Counters[i] - counters.m_Last.m_Counters[i];
+
+        stage.m_Nanoseconds += now.m_Nanoseconds - counters.m_Last.m_Nanoseconds;
+    }
+
+    counters.m_Last = now;
+}
+
+void CounterProfiler::begin(const ProfileStage& stage)
+{
+    auto& counters = threadCounters();
+
+    flush(counters);
+    counters.m_Stack.push_back(stage);
+}
+
+void CounterProfiler::end()
+{
+    auto& counters = threadCounters();
+
+    flush(counters);
+
+    if(!counters.m_Stack.empty())
+        counters.m_Stack.pop_back();
+}
+
+void CounterProfiler::print()
+{
+    QMutexLocker locker(&sm_ThreadsMutex);
+
+    auto totals = std::array<Sample, size_t(ProfileStage::Count)>();
+    auto has_counters = false;
+
+    for(const auto& thread : sm_Threads)
+    {
+        has_counters |= thread->m_GroupFd != -1;
+
+        for(size_t stage = 0; stage < totals.size(); stage++)
+        {
+            for(size_t i = 0; i < NumCounters; i++)
+                totals[stage].m_Counters[i] += thread->m_Stages[stage].m_Counters[i];
+
+            totals[stage].m_Nanoseconds += thread->m_Stages[stage].m_Nanoseconds;
+        }
+    }
+
+    qDebug().noquote() << "Counters:" << sm_Threads.size() << "threads" << (has_counters ? "" : "(hardware counters unavailable, only times are valid)");
+    qDebug().noquote() << QString("stage").leftJustified(14) + QString("cpu ms").rightJustified(10) + QString("Mcycles").rightJustified(12) + QString("Minstr").rightJustified(12) +
+                              QString("ipc").rightJustified(7) + QString("cache mpki").rightJustified(12) + QString("branch mpki").rightJustified(13);
+
+    // misses per thousand instructions
+    const auto per_kilo = [](const quint64& count, const quint64& instructions) -> QString {
+        return instructions == 0 ? QString("-") : QString::number(double(count) * 1000.0 / double(instructions), 'f', 2);
+    };
+
+    for(size_t stage = 0; stage < totals.size(); stage++)
+    {
+        const auto& total = totals[stage];
+        const auto& cycles = total.m_Counters[Cycles];
+        const auto& instructions = total.m_Counters[Instructions];
+
+        qDebug().noquote() << QString(stage_names[stage]).leftJustified(14) + QString::number(double(total.m_Nanoseconds) * 1e-6, 'f', 1).rightJustified(10) +
+                                  QString::number(double(cycles) * 1e-6, 'f', 1).rightJustified(12) + QString::number(double(instructions) * 1e-6, 'f', 1).rightJustified(12) +
+                                  (cycles == 0 ? QString("-") : QString::number(double(instructions) / double(cycles), 'f', 2)).rightJustified(7) +
+                                  per_kilo(total.m_Counters[CacheMisses], instructions).rightJustified(12) + per_kilo(total.m_Counters[BranchMisses], instructions).rightJustified(13);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QtCore/QMutex>
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// what a span is spent on, counters of nested spans go to the innermost one
+enum class ProfileStage
+{
+    Other,
+    Parse,
+    CacheLookup,
+    SceneBuild,
+    Export,
+    TextureCopy,
+    Count
+};
+
+// cycles, instructions, cache and branch misses per worker thread through perf_event_open, summed per stage
+class CounterProfiler
+{
+    enum Counter
+    {
+        Cycles,
+        Instructions,
+        CacheMisses,
+        BranchMisses,
+        NumCounters
+    };
+
+    struct Sample
+    {
+        std::array<quint64, NumCounters> m_Counters = {};
+        // thread cpu time
+        qint64 m_Nanoseconds = 0;
+    };
+
+    // only the owning thread touches its counters while the run is going
+    struct ThreadCounters
+    {
+        int m_GroupFd = -1;
+        std::vector<int> m_Fds;
+
+        std::vector<ProfileStage> m_Stack;
+        Sample m_Last;
+
+        std::array<Sample, size_t(ProfileStage::Count)> m_Stages = {};
+    };
+
+    using Threads = std::deque<std::unique_ptr<ThreadCounters>>;
+
+public:
+    static void start();
+
+    static bool isEnabled()
+    {
+        return sm_Enabled.load(std::memory_order_relaxed);
+    }
+
+    static const char* stageName(const ProfileStage& stage);
+
+    static void begin(const ProfileStage& stage);
+    static void end();
+
+    // per stage table over all threads, call once the workers are idle
+    static void print();
+
+private:
+    static ThreadCounters& threadCounters();
+    static Sample sample(const ThreadCounters& counters);
+
+    // hands everything since the last sample to the innermost open stage
+    static void flush(ThreadCounters& counters);
+
+    static void open(ThreadCounters& counters);
+
+private:
+    static std::atomic<bool> sm_Enabled;
+
+    static QMutex sm_ThreadsMutex;
+    static Threads sm_Threads;
+};
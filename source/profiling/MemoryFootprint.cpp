@@ -0,0 +1,65 @@
+#include "profiling/MemoryFootprint.h"
+
+size_t MemoryFootprint::estimate(const Texture& texture)
+{
+    return sizeof(Texture) + heap(texture);
+}
+
+size_t MemoryFootprint::estimate(const Geometry& geometry)
+{
+    return sizeof(Geometry) + heap(geometry);
+}
+
+size_t MemoryFootprint::estimate(const Level& level)
+{
+    auto result = sizeof(Level) + heap(level.m_LevelName) + heap(level.m_TrileSetName);
+
+    result += heap(level.m_TrileEmplacements);
+    result += heap(level.m_TrileGeometries);
+
+    for(const auto& trile : level.m_TrileGeometries)
+        result += heap(trile.second);
+
+    result += heap(level.m_ArtObjects);
+
+    for(const auto& art_object : level.m_ArtObjects)
+        result += heap(art_object.m_Name);
+
+    result += heap(level.m_ArtObjectGeometries);
+
+    for(const auto& art_object : level.m_ArtObjectGeometries)
+        result += heap(art_object.first) + heap(art_object.second);
+
+    result += heap(level.m_BackgroundPlanes);
+
+    for(const auto& bp : level.m_BackgroundPlanes)
+        result += heap(bp.m_Name) + heap(bp.m_Geometry);
+
+    result += heap(level.m_Characters);
+
+    for(const auto& car : level.m_Characters)
+        result += heap(car.m_Name) + heap(car.m_Geometry);
+
+    result += heap(level.m_BakedGeometries);
+
+    for(const auto& geometry : level.m_BakedGeometries)
+        result += heap(geometry);
+
+    return result;
+}
+
+size_t MemoryFootprint::heap(const QString& string)
+{
+    // utf-16 payload behind qt's array header
+    return string.isNull() ? 0 : size_t(string.capacity() + 1) * sizeof(QChar) + 16;
+}
+
+size_t MemoryFootprint::heap(const Texture& texture)
+{
+    return heap(texture.m_TextureName) + heap(texture.m_TextureOrgFile) + heap(texture.m_TextureAnimationOffsets);
+}
+
+size_t MemoryFootprint::heap(const Geometry& geometry)
+{
+    return heap(geometry.m_Name) + heap(geometry.m_Vertices) + heap(geometry.m_Indices) + heap(geometry.m_Texture);
+}
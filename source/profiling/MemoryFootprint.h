@@ -0,0 +1,34 @@
+#pragma once
+
+#include "model/Level.h"
+
+#include <QtCore/QString>
+
+#include <map>
+#include <vector>
+
+// estimated bytes of the model types, capacities count and implicit sharing is ignored
+class MemoryFootprint
+{
+public:
+    static size_t estimate(const Texture& texture);
+    static size_t estimate(const Geometry& geometry);
+    static size_t estimate(const Level& level);
+
+private:
+    // what the value owns on the heap, its own size belongs to whatever holds it
+    static size_t heap(const QString& string);
+    static size_t heap(const Texture& texture);
+    static size_t heap(const Geometry& geometry);
+
+    template<class T> static size_t heap(const std::vector<T>& values)
+    {
+        return values.capacity() * sizeof(T);
+    }
+
+    // red black tree nodes, three pointers and a color next to every entry
+    template<class K, class V> static size_t heap(const std::map<K, V>& values)
+    {
+        return values.size() * (sizeof(std::pair<const K, V>) + 4 * sizeof(void*));
+    }
+};
@@ -0,0 +1,111 @@
+#include "profiling/MemoryReport.h"
+
+#include "profiling/AllocationCounter.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutexLocker>
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+std::atomic<bool> MemoryReport::sm_Enabled = false;
+
+QMutex MemoryReport::sm_LevelsMutex = {};
+MemoryReport::Levels MemoryReport::sm_Levels = {};
+
+namespace
+{
+    // largest first, that is what gets looked at
+    QJsonArray toJson(std::vector<std::pair<QString, size_t>> entries)
+    {
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        auto result = QJsonArray();
+
+        for(const auto& entry : entries)
+            result.append(QJsonObject{{"name", entry.first}, {"bytes", qint64(entry.second)}});
+
+        return result;
+    }
+}
+
+void MemoryReport::start()
+{
+    sm_Enabled.store(true, std::memory_order_relaxed);
+}
+
+void MemoryReport::addLevel(const QString& name, const size_t& bytes)
+{
+    QMutexLocker locker(&sm_LevelsMutex);
+
+    sm_Levels.push_back({name, bytes});
+}
+
+size_t MemoryReport::peakRss()
+{
+#ifdef _WIN32
+    auto counters = PROCESS_MEMORY_COUNTERS();
+
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+
+    return size_t(counters.PeakWorkingSetSize);
+#else
+    auto usage = rusage();
+
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+#ifdef __APPLE__
+    return size_t(usage.ru_maxrss);
+#else
+    return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+bool MemoryReport::write(const QString& file, const CacheUsages& caches)
+{
+    auto json_caches = QJsonObject();
+
+    for(const auto& cache : caches)
+        json_caches.insert(cache.m_Name, QJsonObject{{"entries", qint64(cache.m_Entries.size())}, {"bytes", qint64(cache.bytes())}, {"assets", toJson(cache.m_Entries)}});
+
+    auto json_allocations = QJsonObject();
+    const auto counts = AllocationCounter::counts();
+
+    for(size_t i = 0; i < counts.size(); i++)
+        json_allocations.insert(CounterProfiler::stageName(ProfileStage(i)), QJsonObject{{"count", qint64(counts[i].m_Allocations)}, {"bytes", qint64(counts[i].m_Bytes)}});
+
+    auto levels = Levels();
+
+    {
+        QMutexLocker locker(&sm_LevelsMutex);
+        levels = sm_Levels;
+    }
+
+    // allocations stay null unless the build counts them
+    const auto report = QJsonObject{{"peakRssBytes", qint64(peakRss())},
+                                    {"caches", json_caches},
+                                    {"levels", toJson(levels)},
+                                    {"allocations", AllocationCounter::isAvailable() ? QJsonValue(json_allocations) : QJsonValue()}};
+
+    QFile report_file(file);
+
+    if(!report_file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return false;
+
+    report_file.write(QJsonDocument(report).toJson(QJsonDocument::JsonFormat::Indented));
+    report_file.close();
+
+    return true;
+}
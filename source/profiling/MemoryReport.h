@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <atomic>
+#include <vector>
+
+// estimated bytes per entry of one cache
+struct CacheUsage
+{
+    using Entries = std::vector<std::pair<QString, size_t>>;
+
+    QString m_Name;
+    Entries m_Entries;
+
+    size_t bytes() const
+    {
+        auto result = size_t(0);
+
+        for(const auto& entry : m_Entries)
+            result += entry.second;
+
+        return result;
+    }
+};
+
+using CacheUsages = std::vector<CacheUsage>;
+
+// per asset footprints, cache totals, allocations per stage and peak rss of one run as json
+class MemoryReport
+{
+    using Levels = std::vector<std::pair<QString, size_t>>;
+
+public:
+    static void start();
+
+    static bool isEnabled()
+    {
+        return sm_Enabled.load(std::memory_order_relaxed);
+    }
+
+    static void addLevel(const QString& name, const size_t& bytes);
+
+    static size_t peakRss();
+
+    static bool write(const QString& file, const CacheUsages& caches);
+
+private:
+    static std::atomic<bool> sm_Enabled;
+
+    static QMutex sm_LevelsMutex;
+    static Levels sm_Levels;
+};
@@ -0,0 +1,95 @@
+#include "profiling/Trace.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+
+std::atomic<bool> Trace::sm_Enabled = false;
+Trace::Clock::time_point Trace::sm_Start = {};
+
+QMutex Trace::sm_ThreadsMutex = {};
+Trace::Threads Trace::sm_Threads = {};
+
+void Trace::start()
+{
+    sm_Start = Clock::now();
+    sm_Enabled.store(true, std::memory_order_relaxed);
+}
+
+qint64 Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sm_Start).count();
+}
+
+Trace::ThreadEvents& Trace::threadEvents()
+{
+    // the buffers outlive pool threads, so nothing is lost when a worker exits
+    thread_local ThreadEvents* thread_events = nullptr;
+
+    if(thread_events)
+        return *thread_events;
+
+    QMutexLocker locker(&sm_ThreadsMutex);
+
+    sm_Threads.push_back(std::make_unique<ThreadEvents>());
+
+    thread_events = sm_Threads.back().get();
+    thread_events->m_ThreadId = int(sm_Threads.size());
+    thread_events->m_IsMainThread = QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread();
+
+    return *thread_events;
+}
+
+bool Trace::write(const QString& file)
+{
+    QMutexLocker locker(&sm_ThreadsMutex);
+
+    auto trace_events = QJsonArray();
+
+    for(const auto& thread : sm_Threads)
+    {
+        const auto thread_name = thread->m_IsMainThread ? QString("main") : "worker " + QString::number(thread->m_ThreadId);
+
+        trace_events.append(QJsonObject{{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", thread->m_ThreadId}, {"args", QJsonObject{{"name", thread_name}}}});
+
+        // complete events in microseconds
+        for(const auto& event : thread->m_Events)
+        {
+            auto trace_event = QJsonObject{{"name", event.m_Name},
+                                           {"cat", "export"},
+                                           {"ph", "X"},
+                                           {"ts", double(event.m_Start) * 1e-3},
+                                           {"dur", double(event.m_Duration) * 1e-3},
+                                           {"pid", 1},
+                                           {"tid", thread->m_ThreadId}};
+
+            if(!event.m_Asset.isEmpty())
+                trace_event.insert("args", QJsonObject{{"asset", event.m_Asset}});
+
+            trace_events.append(trace_event);
+        }
+    }
+
+    QFile trace_file(file);
+
+    if(!trace_file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return false;
+
+    trace_file.write(QJsonDocument(QJsonObject{{"traceEvents", trace_events}, {"displayTimeUnit", "ms"}}).toJson(QJsonDocument::JsonFormat::Compact));
+    trace_file.close();
+
+    return true;
+}
+
+void TraceSpan::record()
+{
+    const auto end = Trace::now();
+
+    Trace::threadEvents().m_Events.push_back({m_Name, std::move(m_Asset), m_Start, end - m_Start});
+
+    m_Name = nullptr;
+}
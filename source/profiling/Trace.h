@@ -0,0 +1,128 @@
+#pragma once
+
+#include "profiling/AllocationCounter.h"
+#include "profiling/CounterProfiler.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// records scoped spans and writes them as chrome trace events, perfetto reads the same file
+class Trace
+{
+    friend class TraceSpan;
+
+    struct Event
+    {
+        const char* m_Name = nullptr;
+        QString m_Asset;
+        qint64 m_Start = 0;
+        qint64 m_Duration = 0;
+    };
+
+    // only the owning thread appends, so recording takes no lock
+    struct ThreadEvents
+    {
+        int m_ThreadId = 0;
+        bool m_IsMainThread = false;
+        std::vector<Event> m_Events;
+    };
+
+    using Clock = std::chrono::steady_clock;
+    using Threads = std::deque<std::unique_ptr<ThreadEvents>>;
+
+public:
+    static void start();
+
+    static bool isEnabled()
+    {
+        return sm_Enabled.load(std::memory_order_relaxed);
+    }
+
+    // every span has to be closed, workers are idle once the exports are waited for
+    static bool write(const QString& file);
+
+private:
+    static qint64 now();
+    static ThreadEvents& threadEvents();
+
+private:
+    static std::atomic<bool> sm_Enabled;
+    static Clock::time_point sm_Start;
+
+    static QMutex sm_ThreadsMutex;
+    static Threads sm_Threads;
+};
+
+// time from construction to end() or destruction, also feeds the stage counters, two relaxed loads when both are off
+class TraceSpan
+{
+public:
+    TraceSpan(const char* name, const QString& asset = {}, const ProfileStage& stage = ProfileStage::Other) : m_Name{nullptr}, m_Start{0}, m_Counted{false}
+    {
+#ifdef FMG_COUNT_ALLOCATIONS
+        m_AllocationStage = AllocationCounter::enter(stage);
+        m_Allocating = true;
+#endif
+
+        if(CounterProfiler::isEnabled())
+        {
+            CounterProfiler::begin(stage);
+            m_Counted = true;
+        }
+
+        if(!Trace::isEnabled())
+            return;
+
+        m_Name = name;
+        m_Asset = asset;
+        m_Start = Trace::now();
+    }
+
+    ~TraceSpan()
+    {
+        end();
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void end()
+    {
+#ifdef FMG_COUNT_ALLOCATIONS
+        if(m_Allocating)
+        {
+            AllocationCounter::leave(m_AllocationStage);
+            m_Allocating = false;
+        }
+#endif
+
+        if(m_Name)
+            record();
+
+        if(!m_Counted)
+            return;
+
+        CounterProfiler::end();
+        m_Counted = false;
+    }
+
+private:
+    void record();
+
+private:
+    const char* m_Name;
+    QString m_Asset;
+    qint64 m_Start;
+    bool m_Counted;
+
+#ifdef FMG_COUNT_ALLOCATIONS
+    ProfileStage m_AllocationStage;
+    bool m_Allocating;
+#endif
+};
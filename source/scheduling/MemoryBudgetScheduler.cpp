@@ -0,0 +1,112 @@
+#include "scheduling/MemoryBudgetScheduler.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFutureSynchronizer>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QXmlStreamReader>
+
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+namespace
+{
+    // rough factors, --memory-report shows the real footprint per level
+    constexpr auto bytes_per_xml_byte = size_t(12);
+    constexpr auto bytes_per_emplacement = size_t(4096);
+}
+
+MemoryBudgetScheduler::MemoryBudgetScheduler(const size_t& budget) : m_Budget{budget}
+{
+}
+
+size_t MemoryBudgetScheduler::estimate(const QString& file)
+{
+    QFile xml_file(file);
+
+    if(!xml_file.open(QIODevice::OpenModeFlag::ReadOnly))
+        return 0;
+
+    // a stream scan, far cheaper than the dom the job builds afterwards and never holds the whole file
+    auto emplacements = size_t(0);
+    QXmlStreamReader reader(&xml_file);
+
+    while(!reader.atEnd())
+    {
+        if(reader.readNext() == QXmlStreamReader::TokenType::StartElement && reader.name() == QString("TrileEmplacement"))
+            emplacements++;
+    }
+
+    return size_t(QFileInfo(file).size()) * bytes_per_xml_byte + emplacements * bytes_per_emplacement;
+}
+
+MemoryBudgetScheduler::Jobs MemoryBudgetScheduler::order(const QStringList& files)
+{
+    // the scans are independent, they run on the pool
+    const auto estimates = QtConcurrent::blockingMapped(files, &MemoryBudgetScheduler::estimate);
+
+    auto result = Jobs();
+
+    for(qsizetype i = 0; i < files.size(); i++)
+        result.push_back({files[i], estimates[i]});
+
+    std::sort(result.begin(), result.end(), [](const Job& a, const Job& b) { return a.m_Estimate > b.m_Estimate; });
+
+    return result;
+}
+
+void MemoryBudgetScheduler::run(const Jobs& jobs, const Function& function) const
+{
+    auto pending = jobs;
+
+    QMutex mutex;
+    QWaitCondition finished;
+
+    auto in_use = size_t(0);
+    auto running = size_t(0);
+
+    auto waiter = QFutureSynchronizer<void>();
+    QMutexLocker locker(&mutex);
+
+    while(!pending.empty())
+    {
+        // admit everything that fits, in order, so smaller jobs fill the gaps of larger ones
+        auto job_iter = pending.begin();
+
+        while(job_iter != pending.end())
+        {
+            if(running != 0 && in_use + job_iter->m_Estimate > m_Budget)
+            {
+                ++job_iter;
+                continue;
+            }
+
+            const auto job = *job_iter;
+            job_iter = pending.erase(job_iter);
+
+            in_use += job.m_Estimate;
+            running++;
+
+            waiter.addFuture(QtConcurrent::run([&function, &mutex, &finished, &in_use, &running, job]() {
+                function(job.m_File);
+
+                QMutexLocker locker(&mutex);
+
+                in_use -= job.m_Estimate;
+                running--;
+
+                finished.wakeAll();
+            }));
+        }
+
+        if(!pending.empty())
+            finished.wait(&mutex);
+    }
+
+    locker.unlock();
+    waiter.waitForFinished();
+}
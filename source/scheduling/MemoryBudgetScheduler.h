@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <functional>
+#include <vector>
+
+// runs level jobs on the global pool while the sum of their estimated memory stays inside a budget
+class MemoryBudgetScheduler
+{
+public:
+    using Function = std::function<void(const QString& file)>;
+
+    struct Job
+    {
+        QString m_File;
+        size_t m_Estimate = 0;
+    };
+
+    using Jobs = std::vector<Job>;
+
+public:
+    MemoryBudgetScheduler(const size_t& budget);
+
+    // largest first, smaller jobs backfill what is left, a job above the whole budget runs alone
+    void run(const Jobs& jobs, const Function& function) const;
+
+    // the estimated jobs in the order run admits them when nothing has finished yet
+    static Jobs order(const QStringList& files);
+
+    // peak bytes of exporting one level, from its xml size and trile emplacement count
+    static size_t estimate(const QString& file);
+
+private:
+    size_t m_Budget;
+};
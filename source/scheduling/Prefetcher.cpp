@@ -0,0 +1,134 @@
+#include "scheduling/Prefetcher.h"
+
+#include "profiling/Trace.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+
+#include <numeric>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+Prefetcher::Prefetcher(const size_t& window) : m_Window{window}
+{
+}
+
+Prefetcher::~Prefetcher()
+{
+    if(!m_Thread)
+        return;
+
+    {
+        QMutexLocker locker(&m_Mutex);
+
+        m_Stop = true;
+        m_Progress.wakeAll();
+    }
+
+    m_Thread->wait();
+}
+
+void Prefetcher::start(const QStringList& files, const Dependencies& dependencies)
+{
+    if(m_Thread || m_Window == 0 || files.empty())
+        return;
+
+    m_Files = files;
+    m_Dependencies = dependencies;
+    m_JobBytes.assign(size_t(m_Files.size()), 0);
+
+    m_Thread.reset(QThread::create([this]() { run(); }));
+    m_Thread->start(QThread::Priority::LowPriority);
+}
+
+void Prefetcher::started()
+{
+    if(!m_Thread)
+        return;
+
+    QMutexLocker locker(&m_Mutex);
+
+    m_NumStarted++;
+    m_Progress.wakeAll();
+}
+
+void Prefetcher::run()
+{
+    for(size_t i = 0; i < m_JobBytes.size(); i++)
+    {
+        {
+            QMutexLocker locker(&m_Mutex);
+
+            // never more than the window ahead, but always at least the next job
+            while(!m_Stop && i > m_NumStarted && std::accumulate(m_JobBytes.begin() + m_NumStarted, m_JobBytes.begin() + i, size_t(0)) > m_Window)
+                m_Progress.wait(&m_Mutex);
+
+            if(m_Stop)
+                return;
+
+            // workers already past this job read it themselves
+            if(i < m_NumStarted)
+                continue;
+        }
+
+        const auto& job_file = m_Files[qsizetype(i)];
+
+        TraceSpan span("prefetch", QFileInfo(job_file).baseName());
+
+        auto bytes = size_t(0);
+
+        // shared trile sets and textures are read once
+        for(const auto& file : m_Dependencies(job_file))
+        {
+            if(m_Prefetched.insert(file).second)
+                bytes += advise(file);
+        }
+
+        QMutexLocker locker(&m_Mutex);
+        m_JobBytes[i] = bytes;
+    }
+}
+
+size_t Prefetcher::advise(const QString& file)
+{
+#ifdef Q_OS_LINUX
+    // the kernel reads the whole file in the background, nothing is copied here
+    const auto fd = ::open(QFile::encodeName(file).constData(), O_RDONLY);
+
+    if(fd < 0)
+        return 0;
+
+    const auto size = size_t(QFileInfo(file).size());
+
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    ::close(fd);
+
+    return size;
+#else
+    // no hint available, reading it through leaves it in the file cache
+    QFile input(file);
+
+    if(!input.open(QIODevice::OpenModeFlag::ReadOnly))
+        return 0;
+
+    static thread_local auto buffer = QByteArray(1024 * 1024, Qt::Initialization::Uninitialized);
+
+    auto size = size_t(0);
+
+    while(!input.atEnd())
+    {
+        const auto read = input.read(buffer.data(), buffer.size());
+
+        if(read <= 0)
+            break;
+
+        size += size_t(read);
+    }
+
+    return size;
+#endif
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QtCore/QMutex>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <functional>
+#include <memory>
+#include <set>
+#include <vector>
+
+// reads the input files of upcoming jobs ahead of the workers so their opens hit the page cache
+class Prefetcher
+{
+public:
+    // the files a job opens, resolved on the prefetch thread once the job comes into the window
+    using Dependencies = std::function<QStringList(const QString& file)>;
+
+public:
+    // bytes read ahead of the jobs not started yet
+    Prefetcher(const size_t& window);
+    ~Prefetcher();
+
+    // one job per file, in the order the workers take them
+    void start(const QStringList& files, const Dependencies& dependencies);
+
+    // a worker took the next job, its share of the window is free again
+    void started();
+
+private:
+    void run();
+
+    // hints or reads one file, returns its size
+    static size_t advise(const QString& file);
+
+private:
+    size_t m_Window;
+
+    QStringList m_Files;
+    Dependencies m_Dependencies;
+    std::vector<size_t> m_JobBytes;
+    std::set<QString> m_Prefetched;
+
+    size_t m_NumStarted = 0;
+    bool m_Stop = false;
+
+    QMutex m_Mutex;
+    QWaitCondition m_Progress;
+
+    std::unique_ptr<QThread> m_Thread;
+};
@@ -0,0 +1,115 @@
+#include "scheduling/ShardPlanner.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QXmlStreamReader>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+ShardPlanner::ShardPlanner(const Shard& shard) : m_Shard{shard}
+{
+}
+
+ShardPlanner::Assignment ShardPlanner::plan(const QStringList& artObjects, const QStringList& trileSets, const QStringList& levels) const
+{
+    auto groups = std::map<QString, Group>();
+
+    for(const auto& file : trileSets)
+    {
+        const auto key = "ts:" + QFileInfo(file).baseName();
+        auto& group = groups[key];
+
+        group.m_Key = key;
+        group.m_Bytes += QFileInfo(file).size();
+        group.m_Files.m_TrileSets.push_back(file);
+    }
+
+    // a level without a readable trile set still forms a group of its own set name
+    for(const auto& file : levels)
+    {
+        const auto key = "ts:" + trileSetName(file);
+        auto& group = groups[key];
+
+        group.m_Key = key;
+        group.m_Bytes += QFileInfo(file).size();
+        group.m_Files.m_Levels.push_back(file);
+    }
+
+    for(const auto& file : artObjects)
+    {
+        const auto key = "ao:" + QFileInfo(file).baseName();
+        auto& group = groups[key];
+
+        group.m_Key = key;
+        group.m_Bytes += QFileInfo(file).size();
+        group.m_Files.m_ArtObjects.push_back(file);
+    }
+
+    // largest group to the least loaded shard, ties broken by key and index so every process agrees
+    auto sorted = std::vector<const Group*>();
+
+    for(const auto& group : groups)
+        sorted.push_back(&group.second);
+
+    std::sort(sorted.begin(), sorted.end(), [](const Group* a, const Group* b) { return a->m_Bytes != b->m_Bytes ? a->m_Bytes > b->m_Bytes : a->m_Key < b->m_Key; });
+
+    auto loads = std::vector<size_t>(size_t(m_Shard.m_Count), 0);
+    auto result = Assignment();
+
+    for(const auto& group : sorted)
+    {
+        const auto shard = size_t(std::min_element(loads.cbegin(), loads.cend()) - loads.cbegin());
+
+        loads[shard] += std::max(group->m_Bytes, size_t(1));
+
+        if(int(shard) + 1 != m_Shard.m_Index)
+            continue;
+
+        result.m_ArtObjects += group->m_Files.m_ArtObjects;
+        result.m_TrileSets += group->m_Files.m_TrileSets;
+        result.m_Levels += group->m_Files.m_Levels;
+    }
+
+    return result;
+}
+
+std::optional<Shard> ShardPlanner::parse(const QString& text)
+{
+    const auto parts = text.split('/');
+
+    if(parts.size() != 2)
+        return {};
+
+    auto index_ok = false;
+    auto count_ok = false;
+
+    const auto result = Shard{parts[0].toInt(&index_ok), parts[1].toInt(&count_ok)};
+
+    if(!index_ok || !count_ok || result.m_Count < 1 || result.m_Index < 1 || result.m_Index > result.m_Count)
+        return {};
+
+    return result;
+}
+
+QString ShardPlanner::trileSetName(const QString& levelFile)
+{
+    QFile xml_file(levelFile);
+
+    if(!xml_file.open(QIODevice::OpenModeFlag::ReadOnly))
+        return {};
+
+    QXmlStreamReader reader(&xml_file);
+
+    while(!reader.atEnd())
+    {
+        if(reader.readNext() != QXmlStreamReader::TokenType::StartElement)
+            continue;
+
+        // the root element, everything after it is irrelevant
+        return reader.name() == QString("Level") ? reader.attributes().value("trileSetName").toString() : QString();
+    }
+
+    return {};
+}
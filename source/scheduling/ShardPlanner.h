@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <optional>
+
+// which part of the content one of several exporter processes takes
+struct Shard
+{
+    // 1 based
+    int m_Index = 1;
+    int m_Count = 1;
+
+    QString name() const
+    {
+        return QString::number(m_Index) + "_of_" + QString::number(m_Count);
+    }
+};
+
+// splits the content between processes, every process computes the same plan from the same files
+class ShardPlanner
+{
+public:
+    struct Assignment
+    {
+        QStringList m_ArtObjects;
+        QStringList m_TrileSets;
+        QStringList m_Levels;
+    };
+
+private:
+    // a trile set and every level built from it, or a single art object
+    struct Group
+    {
+        QString m_Key;
+        size_t m_Bytes = 0;
+        Assignment m_Files;
+    };
+
+public:
+    ShardPlanner(const Shard& shard);
+
+    // levels go with their trile set, so its cache entry is parsed once; groups are balanced by file size
+    Assignment plan(const QStringList& artObjects, const QStringList& trileSets, const QStringList& levels) const;
+
+    // "i/N" with 1 <= i <= N
+    static std::optional<Shard> parse(const QString& text);
+
+    // trileSetName of the Level element, without reading past it
+    static QString trileSetName(const QString& levelFile);
+
+private:
+    Shard m_Shard;
+};
@@ -0,0 +1,95 @@
+#include "texture/AlphaClassifier.h"
+#include "texture/ImageCache.h"
+
+#include <QtGui/QImage>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FMG_ALPHA_SSE2
+#endif
+
+TextureAlpha AlphaClassifier::classify(const QImage& image)
+{
+    if(image.isNull())
+        return TextureAlpha::Unknown;
+
+    if(!image.hasAlphaChannel())
+        return TextureAlpha::Opaque;
+
+    // non premultiplied 0xAARRGGBB words, converts only if the decoder picked another format
+    const auto argb = image.format() == QImage::Format::Format_ARGB32 ? image : image.convertToFormat(QImage::Format::Format_ARGB32);
+
+    auto result = TextureAlpha::Opaque;
+
+    for(int y = 0; y < argb.height(); y++)
+    {
+        const auto line = reinterpret_cast<const uint32_t*>(argb.constScanLine(y));
+        const auto line_result = classifyScanLine(line, size_t(argb.width()));
+
+        if(line_result == TextureAlpha::Translucent)
+            return TextureAlpha::Translucent;
+
+        if(line_result == TextureAlpha::Cutout)
+            result = TextureAlpha::Cutout;
+    }
+
+    return result;
+}
+
+TextureAlpha AlphaClassifier::classify(const QString& file)
+{
+    const auto info = ImageCache::probe(file);
+
+    // without alpha in the header there is nothing to decode
+    if(info && !info->m_HasAlpha)
+        return TextureAlpha::Opaque;
+
+    return classify(ImageCache::image(file));
+}
+
+TextureAlpha AlphaClassifier::classifyScanLine(const uint32_t* pixels, const size_t& count)
+{
+    auto has_transparent = false;
+    auto has_partial = false;
+    auto i = size_t(0);
+
+#ifdef FMG_ALPHA_SSE2
+    // four pixels per step, alpha shifted to the low byte of every lane
+    const auto opaque = _mm_set1_epi32(0xff);
+    const auto clear = _mm_setzero_si128();
+
+    auto any_transparent = _mm_setzero_si128();
+    auto any_partial = _mm_setzero_si128();
+
+    for(; i + 4 <= count; i += 4)
+    {
+        const auto alpha = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i)), 24);
+
+        const auto is_opaque = _mm_cmpeq_epi32(alpha, opaque);
+        const auto is_clear = _mm_cmpeq_epi32(alpha, clear);
+
+        any_transparent = _mm_or_si128(any_transparent, _mm_andnot_si128(is_opaque, _mm_set1_epi32(-1)));
+        any_partial = _mm_or_si128(any_partial, _mm_andnot_si128(_mm_or_si128(is_opaque, is_clear), _mm_set1_epi32(-1)));
+
+        // a single partial alpha decides the line
+        if((i & 63) == 0 && _mm_movemask_epi8(any_partial) != 0)
+            return TextureAlpha::Translucent;
+    }
+
+    has_transparent = _mm_movemask_epi8(any_transparent) != 0;
+    has_partial = _mm_movemask_epi8(any_partial) != 0;
+#endif
+
+    for(; i < count && !has_partial; i++)
+    {
+        const auto alpha = pixels[i] >> 24;
+
+        has_transparent = has_transparent || alpha != 0xff;
+        has_partial = alpha != 0xff && alpha != 0x00;
+    }
+
+    if(has_partial)
+        return TextureAlpha::Translucent;
+
+    return has_transparent ? TextureAlpha::Cutout : TextureAlpha::Opaque;
+}
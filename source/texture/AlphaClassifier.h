@@ -0,0 +1,18 @@
+#pragma once
+
+#include "model/Texture.h"
+
+#include <cstdint>
+
+class QImage;
+
+class AlphaClassifier
+{
+public:
+    // opaque when every alpha is 255, cutout when alpha is only 0 or 255, translucent otherwise
+    static TextureAlpha classify(const QImage& image);
+    static TextureAlpha classify(const QString& file);  // through ImageCache, png headers without alpha skip decoding
+
+private:
+    static TextureAlpha classifyScanLine(const uint32_t* pixels, const size_t& count);
+};
@@ -0,0 +1,222 @@
+#include "texture/BlockCompressor.h"
+
+#include <QtGui/QImage>
+
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FMG_BLOCK_SSE2
+#endif
+
+namespace
+{
+    uint16_t toRgb565(const int& r, const int& g, const int& b)
+    {
+        return uint16_t(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+    }
+
+    std::array<int, 3> fromRgb565(const uint16_t& c)
+    {
+        const auto r = (c >> 11) & 31;
+        const auto g = (c >> 5) & 63;
+        const auto b = c & 31;
+
+        return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+    }
+
+    int channel(const uint32_t& pixel, const int& shift)
+    {
+        return int((pixel >> shift) & 0xff);
+    }
+
+    // dot products of all 16 pixels with an rgb direction
+    void projectBlock(const std::array<uint32_t, 16>& block, const std::array<int, 3>& direction, std::array<int, 16>& dots)
+    {
+#ifdef FMG_BLOCK_SSE2
+        const auto zero = _mm_setzero_si128();
+        const auto weights = _mm_setr_epi16(int16_t(direction[2]), int16_t(direction[1]), int16_t(direction[0]), 0,  //
+                                            int16_t(direction[2]), int16_t(direction[1]), int16_t(direction[0]), 0);
+
+        for(size_t i = 0; i < 16; i += 4)
+        {
+            // bgra bytes widened to 16 bit, b * db + g * dg and r * dr per pixel
+            const auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.data() + i));
+
+            const auto low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights);
+            const auto high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights);
+
+            const auto low_sum = _mm_add_epi32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+            const auto high_sum = _mm_add_epi32(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+
+            dots[i + 0] = _mm_cvtsi128_si32(low_sum);
+            dots[i + 1] = _mm_cvtsi128_si32(_mm_srli_si128(low_sum, 8));
+            dots[i + 2] = _mm_cvtsi128_si32(high_sum);
+            dots[i + 3] = _mm_cvtsi128_si32(_mm_srli_si128(high_sum, 8));
+        }
+#else
+        for(size_t i = 0; i < 16; i++)
+            dots[i] = channel(block[i], 16) * direction[0] + channel(block[i], 8) * direction[1] + channel(block[i], 0) * direction[2];
+#endif
+    }
+}
+
+QByteArray BlockCompressor::compress(const QImage& image, const Format& format)
+{
+    const auto argb = image.format() == QImage::Format::Format_ARGB32 ? image : image.convertToFormat(QImage::Format::Format_ARGB32);
+
+    const auto width = argb.width();
+    const auto height = argb.height();
+    const auto blocks_x = (width + 3) / 4;
+    const auto blocks_y = (height + 3) / 4;
+    const auto block_size = blockSize(format);
+
+    auto result = QByteArray(qsizetype(blocks_x) * blocks_y * block_size, '\0');
+
+    if(width == 0 || height == 0)
+        return result;
+
+    auto rows = std::vector<int>(blocks_y);
+    std::iota(rows.begin(), rows.end(), 0);
+
+    const auto dst = reinterpret_cast<uint8_t*>(result.data());
+
+    QtConcurrent::blockingMap(rows, [&](const int& row) {
+        auto block = Block();
+
+        for(int bx = 0; bx < blocks_x; bx++)
+        {
+            for(int y = 0; y < 4; y++)
+            {
+                const auto line = reinterpret_cast<const uint32_t*>(argb.constScanLine(std::min(row * 4 + y, height - 1)));
+
+                for(int x = 0; x < 4; x++)
+                    block[y * 4 + x] = line[std::min(bx * 4 + x, width - 1)];
+            }
+
+            auto block_dst = dst + (size_t(row) * blocks_x + bx) * block_size;
+
+            if(format == Format::Bc3)
+            {
+                compressAlpha(block, block_dst);
+                block_dst += 8;
+            }
+
+            compressColor(block, block_dst, format == Format::Bc3);
+        }
+    });
+
+    return result;
+}
+
+size_t BlockCompressor::blockSize(const Format& format) noexcept
+{
+    return format == Format::Bc1 ? 8 : 16;
+}
+
+void BlockCompressor::compressColor(const Block& block, uint8_t* dst, const bool& skipTransparent)
+{
+    // endpoints are the two most distant colors of the block, blocks of up to two colors stay exact
+    auto first = size_t(0);
+    auto second = size_t(0);
+    auto max_distance = -1;
+
+    for(size_t i = 0; i < 16; i++)
+    {
+        if(skipTransparent && channel(block[i], 24) == 0)
+            continue;
+
+        for(size_t k = i; k < 16; k++)
+        {
+            if(skipTransparent && channel(block[k], 24) == 0)
+                continue;
+
+            const auto dr = channel(block[i], 16) - channel(block[k], 16);
+            const auto dg = channel(block[i], 8) - channel(block[k], 8);
+            const auto db = channel(block[i], 0) - channel(block[k], 0);
+            const auto distance = dr * dr + dg * dg + db * db;
+
+            if(distance > max_distance)
+            {
+                max_distance = distance;
+                first = i;
+                second = k;
+            }
+        }
+    }
+
+    auto c0 = toRgb565(channel(block[first], 16), channel(block[first], 8), channel(block[first], 0));
+    auto c1 = toRgb565(channel(block[second], 16), channel(block[second], 8), channel(block[second], 0));
+
+    // four color mode needs c0 > c1
+    if(c0 < c1)
+        std::swap(c0, c1);
+
+    auto indices = uint32_t(0);
+
+    if(c0 != c1)
+    {
+        const auto e0 = fromRgb565(c0);
+        const auto e1 = fromRgb565(c1);
+        const auto direction = std::array<int, 3>{e0[0] - e1[0], e0[1] - e1[1], e0[2] - e1[2]};
+
+        const auto d0 = e0[0] * direction[0] + e0[1] * direction[1] + e0[2] * direction[2];
+        const auto d1 = e1[0] * direction[0] + e1[1] * direction[1] + e1[2] * direction[2];
+
+        auto dots = std::array<int, 16>();
+        projectBlock(block, direction, dots);
+
+        // position along c1 -> c0 in thirds to the palette index
+        static constexpr auto palette = std::array<uint32_t, 4>{1, 3, 2, 0};
+
+        for(size_t i = 0; i < 16; i++)
+        {
+            const auto t = std::clamp(int((int64_t(dots[i] - d1) * 6 + (d0 - d1)) / (2 * int64_t(d0 - d1))), 0, 3);
+            indices |= palette[t] << (2 * i);
+        }
+    }
+
+    dst[0] = uint8_t(c0 & 0xff);
+    dst[1] = uint8_t(c0 >> 8);
+    dst[2] = uint8_t(c1 & 0xff);
+    dst[3] = uint8_t(c1 >> 8);
+
+    for(size_t i = 0; i < 4; i++)
+        dst[4 + i] = uint8_t(indices >> (8 * i));
+}
+
+void BlockCompressor::compressAlpha(const Block& block, uint8_t* dst)
+{
+    auto a0 = 0;
+    auto a1 = 255;
+
+    for(const auto& pixel : block)
+    {
+        a0 = std::max(a0, channel(pixel, 24));
+        a1 = std::min(a1, channel(pixel, 24));
+    }
+
+    // eight value mode, index 0 is a0, 1 is a1 and 2 to 7 interpolate from a0 to a1
+    auto indices = uint64_t(0);
+
+    if(a0 != a1)
+    {
+        for(size_t i = 0; i < 16; i++)
+        {
+            const auto t = ((channel(block[i], 24) - a1) * 14 + (a0 - a1)) / (2 * (a0 - a1));
+            const auto index = t == 7 ? 0 : t == 0 ? 1 : 8 - t;
+
+            indices |= uint64_t(index) << (3 * i);
+        }
+    }
+
+    dst[0] = uint8_t(a0);
+    dst[1] = uint8_t(a1);
+
+    for(size_t i = 0; i < 6; i++)
+        dst[2 + i] = uint8_t(indices >> (8 * i));
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QtCore/QByteArray>
+
+#include <array>
+#include <cstdint>
+
+class QImage;
+
+class BlockCompressor
+{
+    using Block = std::array<uint32_t, 16>;
+
+public:
+    enum class Format
+    {
+        Bc1,
+        Bc3
+    };
+
+    // 4x4 blocks in row order, edge blocks repeat the last row and column, rows of blocks run in parallel
+    static QByteArray compress(const QImage& image, const Format& format);
+
+    static size_t blockSize(const Format& format) noexcept;
+
+private:
+    static void compressColor(const Block& block, uint8_t* dst, const bool& skipTransparent);
+    static void compressAlpha(const Block& block, uint8_t* dst);
+};
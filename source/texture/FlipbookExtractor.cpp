@@ -0,0 +1,143 @@
+#include "texture/FlipbookExtractor.h"
+
+#include "texture/ImageCache.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRect>
+#include <QtCore/QtEndian>
+
+#include <QtGui/QImage>
+
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+QMutex FlipbookExtractor::sm_ExtractedMutex = {};
+FlipbookExtractor::Extracted FlipbookExtractor::sm_Extracted = {};
+
+FlipbookExtractor::FlipbookExtractor(const QString& path) : m_Path{path}
+{
+}
+
+FlipbookExtractor::~FlipbookExtractor()
+{
+}
+
+bool FlipbookExtractor::extract(const Texture& texture)
+{
+    if(!texture.m_IsAnimated || texture.m_TextureAnimationOffsets.empty())
+        return false;
+
+    auto sheet = std::shared_ptr<Sheet>();
+
+    {
+        QMutexLocker locker(&sm_ExtractedMutex);
+
+        auto& extracted = sm_Extracted[texture.m_TextureOrgFile];
+
+        if(!extracted)
+            extracted = std::make_shared<Sheet>();
+
+        sheet = extracted;
+    }
+
+    // extract outside the map lock, a failed sheet stays failed instead of reporting frames that were never written
+    std::call_once(sheet->m_Extracted, [this, &sheet, &texture]() { sheet->m_Succeeded = extractSheet(texture); });
+
+    return sheet->m_Succeeded;
+}
+
+bool FlipbookExtractor::extractSheet(const Texture& texture) const
+{
+    const auto decoded = ImageCache::image(texture.m_TextureOrgFile);
+
+    if(decoded.isNull())
+        return false;
+
+    const auto sheet = decoded.format() == QImage::Format::Format_ARGB32 ? decoded : decoded.convertToFormat(QImage::Format::Format_ARGB32);
+
+    // character textures live in sub folders, keep them
+    const auto base_name = m_Path + "/" + QString(texture.m_TextureName).replace(".ani.png", "");
+    const auto base_dir = QDir(QFileInfo(base_name).absolutePath());
+
+    if(!base_dir.exists())
+        base_dir.mkpath(".");
+
+    // frame rectangles in pixels of the decoded sheet
+    const auto& offsets = texture.m_TextureAnimationOffsets;
+
+    auto rects = std::vector<QRect>(offsets.size());
+    auto frame_width = 0;
+    auto frame_height = 0;
+
+    for(size_t i = 0; i < offsets.size(); i++)
+    {
+        const auto& position = std::get<1>(offsets[i]);
+        const auto& size = std::get<2>(offsets[i]);
+
+        const auto x = std::clamp(int(std::lround(position.x() * float(sheet.width()))), 0, sheet.width());
+        const auto y = std::clamp(int(std::lround(position.y() * float(sheet.height()))), 0, sheet.height());
+        const auto w = std::clamp(int(std::lround(size.x() * float(sheet.width()))), 0, sheet.width() - x);
+        const auto h = std::clamp(int(std::lround(size.y() * float(sheet.height()))), 0, sheet.height() - y);
+
+        if(w == 0 || h == 0)
+            return false;
+
+        rects[i] = QRect(x, y, w, h);
+        frame_width = std::max(frame_width, w);
+        frame_height = std::max(frame_height, h);
+    }
+
+    auto frames = std::vector<size_t>(offsets.size());
+    std::iota(frames.begin(), frames.end(), size_t(0));
+
+    auto succeeded = std::atomic<bool>(true);
+
+    // frames are views into the decoded sheet, only the png encoder touches the pixels
+    QtConcurrent::blockingMap(frames, [&sheet, &rects, &base_name, &succeeded](const size_t& frame) {
+        const auto& rect = rects[frame];
+
+        const auto view = QImage(sheet.constBits() + qsizetype(rect.y()) * sheet.bytesPerLine() + qsizetype(rect.x()) * 4, rect.width(), rect.height(),
+                                 sheet.bytesPerLine(), QImage::Format::Format_ARGB32);
+
+        if(!view.save(base_name + "_" + QString::number(frame).rightJustified(3, '0') + ".png"))
+            succeeded = false;
+    });
+
+    return writeTimings(base_name + ".frames", texture, frame_width, frame_height) && succeeded;
+}
+
+bool FlipbookExtractor::writeTimings(const QString& file, const Texture& texture, const int& frameWidth, const int& frameHeight) const
+{
+    // little endian: "FLIP", u16 version, u16 frame count, u16 frame width, u16 frame height, u32 duration per frame as listed in FramePC
+    const auto& offsets = texture.m_TextureAnimationOffsets;
+
+    auto data = QByteArray(12 + 4 * offsets.size(), '\0');
+    auto dst = data.data();
+
+    std::memcpy(dst, "FLIP", 4);
+    qToLittleEndian<quint16>(1, dst + 4);
+    qToLittleEndian<quint16>(quint16(offsets.size()), dst + 6);
+    qToLittleEndian<quint16>(quint16(frameWidth), dst + 8);
+    qToLittleEndian<quint16>(quint16(frameHeight), dst + 10);
+
+    for(size_t i = 0; i < offsets.size(); i++)
+        qToLittleEndian<quint32>(std::get<0>(offsets[i]), dst + 12 + 4 * i);
+
+    QFile timings(file);
+
+    if(!timings.open(QIODevice::OpenModeFlag::WriteOnly))
+        return false;
+
+    timings.write(data);
+    timings.close();
+
+    return true;
+}
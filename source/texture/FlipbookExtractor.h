@@ -0,0 +1,40 @@
+#pragma once
+
+#include "model/Texture.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+class FlipbookExtractor
+{
+    struct Sheet
+    {
+        std::once_flag m_Extracted;
+        bool m_Succeeded = false;
+    };
+
+    using Extracted = std::map<QString, std::shared_ptr<Sheet>>;
+
+public:
+    FlipbookExtractor(const QString& path);
+    ~FlipbookExtractor();
+
+    // writes <name>_<frame>.png per FramePC rectangle and <name>.frames, every sheet once per run
+    // concurrent requests for a sheet wait for the first and get its result
+    bool extract(const Texture& texture);
+
+private:
+    bool extractSheet(const Texture& texture) const;
+
+    bool writeTimings(const QString& file, const Texture& texture, const int& frameWidth, const int& frameHeight) const;
+
+private:
+    QString m_Path;
+
+    static QMutex sm_ExtractedMutex;
+    static Extracted sm_Extracted;
+};
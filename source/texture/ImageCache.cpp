@@ -0,0 +1,174 @@
+#include "texture/ImageCache.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QtEndian>
+
+#include <array>
+#include <cstring>
+
+QMutex ImageCache::sm_EntriesMutex = {};
+ImageCache::Entries ImageCache::sm_Entries = {};
+
+size_t ImageCache::sm_Bytes = 0;
+size_t ImageCache::sm_Limit = size_t(512) * 1024 * 1024;
+uint64_t ImageCache::sm_Uses = 0;
+
+ImageCache::ImageInfoResult ImageCache::probe(const QString& file)
+{
+    static constexpr auto png_signature = std::array<char, 8>{'\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n'};
+
+    QFile png(file);
+
+    if(!png.open(QIODevice::OpenModeFlag::ReadOnly))
+        return {};
+
+    const auto signature = png.read(8);
+
+    if(signature.size() != 8 || std::memcmp(signature.constData(), png_signature.data(), png_signature.size()) != 0)
+        return {};
+
+    ImageInfo result;
+    auto has_header = false;
+    auto color_type = 0;
+
+    while(!png.atEnd())
+    {
+        const auto chunk_header = png.read(8);
+
+        if(chunk_header.size() != 8)
+            return {};
+
+        const auto length = qFromBigEndian<quint32>(chunk_header.constData());
+        const auto type = chunk_header.mid(4, 4);
+
+        if(type == "IHDR")
+        {
+            const auto ihdr = png.read(13);
+
+            if(length != 13 || ihdr.size() != 13)
+                return {};
+
+            result.m_Width = qFromBigEndian<quint32>(ihdr.constData() + 0);
+            result.m_Height = qFromBigEndian<quint32>(ihdr.constData() + 4);
+            color_type = int(quint8(ihdr[9]));
+
+            // gray alpha and rgba
+            result.m_HasAlpha = color_type == 4 || color_type == 6;
+            has_header = true;
+
+            png.seek(png.pos() + 4);
+            continue;
+        }
+
+        // palette or color key transparency
+        if(type == "tRNS")
+            result.m_HasAlpha = true;
+
+        if(type == "IDAT" || type == "IEND")
+            break;
+
+        png.seek(png.pos() + qint64(length) + 4);
+    }
+
+    if(!has_header)
+        return {};
+
+    return result;
+}
+
+QImage ImageCache::image(const QString& file)
+{
+    auto entry = std::shared_ptr<Entry>();
+
+    {
+        QMutexLocker locker(&sm_EntriesMutex);
+
+        auto& cached = sm_Entries[file];
+
+        if(!cached)
+            cached = std::make_shared<Entry>();
+
+        cached->m_LastUse = ++sm_Uses;
+        entry = cached;
+    }
+
+    // decode outside the map lock, concurrent requests for the same file wait for the first
+    auto decoded = false;
+
+    std::call_once(entry->m_Decoded, [&entry, &file, &decoded]() {
+        entry->m_Image = QImage(file);
+        decoded = true;
+    });
+
+    if(!decoded)
+        return entry->m_Image;
+
+    QMutexLocker locker(&sm_EntriesMutex);
+
+    // evicted or cleared while decoding, nothing to account for
+    const auto entry_find_iter = sm_Entries.find(file);
+
+    if(entry_find_iter == sm_Entries.cend() || entry_find_iter->second != entry)
+        return entry->m_Image;
+
+    entry->m_Bytes = size_t(entry->m_Image.sizeInBytes());
+    sm_Bytes += entry->m_Bytes;
+
+    evict(file);
+
+    return entry->m_Image;
+}
+
+void ImageCache::setLimit(const size_t& bytes)
+{
+    QMutexLocker locker(&sm_EntriesMutex);
+
+    sm_Limit = bytes;
+
+    evict({});
+}
+
+void ImageCache::clear()
+{
+    QMutexLocker locker(&sm_EntriesMutex);
+
+    sm_Entries.clear();
+    sm_Bytes = 0;
+}
+
+void ImageCache::evict(const QString& keep)
+{
+    while(sm_Bytes > sm_Limit)
+    {
+        // entries still decoding have no bytes yet and stay
+        auto oldest = sm_Entries.end();
+
+        for(auto entry_iter = sm_Entries.begin(); entry_iter != sm_Entries.end(); ++entry_iter)
+        {
+            if(entry_iter->second->m_Bytes == 0 || entry_iter->first == keep)
+                continue;
+
+            if(oldest == sm_Entries.end() || entry_iter->second->m_LastUse < oldest->second->m_LastUse)
+                oldest = entry_iter;
+        }
+
+        if(oldest == sm_Entries.end())
+            return;
+
+        sm_Bytes -= oldest->second->m_Bytes;
+        sm_Entries.erase(oldest);
+    }
+}
+
+CacheUsage ImageCache::usage()
+{
+    QMutexLocker locker(&sm_EntriesMutex);
+
+    auto result = CacheUsage{"images", {}};
+
+    for(const auto& entry : sm_Entries)
+        result.m_Entries.push_back({entry.first, entry.second->m_Bytes});
+
+    return result;
+}
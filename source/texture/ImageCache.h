@@ -0,0 +1,65 @@
+#pragma once
+
+#include "profiling/MemoryReport.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <QtGui/QImage>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+class ImageCache
+{
+public:
+    // what the png header tells without decoding
+    struct ImageInfo
+    {
+        unsigned int m_Width = 0;
+        unsigned int m_Height = 0;
+        bool m_HasAlpha = false;
+    };
+
+    using ImageInfoResult = std::optional<ImageInfo>;
+
+private:
+    struct Entry
+    {
+        std::once_flag m_Decoded;
+        QImage m_Image;
+        size_t m_Bytes = 0;
+        uint64_t m_LastUse = 0;
+    };
+
+    using Entries = std::map<QString, std::shared_ptr<Entry>>;
+
+public:
+    // reads IHDR and looks for tRNS, stops at the first IDAT
+    static ImageInfoResult probe(const QString& file);
+
+    // decodes every file at most once while it stays cached, the QImage is implicitly shared
+    static QImage image(const QString& file);
+
+    // least recently used images are dropped once the decoded bytes exceed the limit, callers keep their copies
+    static void setLimit(const size_t& bytes);
+
+    static void clear();
+
+    // decoded bytes per image, call once the workers are idle
+    static CacheUsage usage();
+
+private:
+    // with the map lock held
+    static void evict(const QString& keep);
+
+private:
+    static QMutex sm_EntriesMutex;
+    static Entries sm_Entries;
+
+    static size_t sm_Bytes;
+    static size_t sm_Limit;
+    static uint64_t sm_Uses;
+};
@@ -0,0 +1,120 @@
+#include "texture/SkylinePacker.h"
+
+#include <algorithm>
+#include <limits>
+
+SkylinePacker::SkylinePacker(const int& width, const int& height) : m_Width{width}, m_Height{height}, m_Skyline{{0, 0, width}}
+{
+}
+
+SkylinePacker::~SkylinePacker()
+{
+}
+
+SkylinePacker::InsertResult SkylinePacker::insert(const int& width, const int& height)
+{
+    if(width <= 0 || height <= 0 || width > m_Width || height > m_Height)
+        return {};
+
+    auto best_segment = m_Skyline.size();
+    auto best_top = std::numeric_limits<int>::max();
+    auto best_waste = std::numeric_limits<int>::max();
+    auto best_y = 0;
+
+    for(size_t i = 0; i < m_Skyline.size(); i++)
+    {
+        const auto y = fit(i, width, height);
+
+        if(!y)
+            continue;
+
+        // area below the rectangle that can never be used again
+        auto waste = 0;
+
+        for(size_t k = i; k < m_Skyline.size() && m_Skyline[k].m_X < m_Skyline[i].m_X + width; k++)
+        {
+            const auto right = std::min(m_Skyline[k].m_X + m_Skyline[k].m_Width, m_Skyline[i].m_X + width);
+            waste += (right - m_Skyline[k].m_X) * (*y - m_Skyline[k].m_Y);
+        }
+
+        const auto top = *y + height;
+
+        if(top < best_top || (top == best_top && waste < best_waste))
+        {
+            best_segment = i;
+            best_top = top;
+            best_waste = waste;
+            best_y = *y;
+        }
+    }
+
+    if(best_segment == m_Skyline.size())
+        return {};
+
+    const auto x = m_Skyline[best_segment].m_X;
+
+    // raise the skyline under the new rectangle
+    m_Skyline.insert(m_Skyline.begin() + best_segment, {x, best_top, width});
+
+    for(auto i = best_segment + 1; i < m_Skyline.size();)
+    {
+        auto& segment = m_Skyline[i];
+        const auto shadow = x + width - segment.m_X;
+
+        if(shadow <= 0)
+            break;
+
+        if(shadow < segment.m_Width)
+        {
+            segment.m_X += shadow;
+            segment.m_Width -= shadow;
+            break;
+        }
+
+        m_Skyline.erase(m_Skyline.begin() + i);
+    }
+
+    // merge neighbours at the same height
+    for(size_t i = 0; i + 1 < m_Skyline.size();)
+    {
+        if(m_Skyline[i].m_Y != m_Skyline[i + 1].m_Y)
+        {
+            i++;
+            continue;
+        }
+
+        m_Skyline[i].m_Width += m_Skyline[i + 1].m_Width;
+        m_Skyline.erase(m_Skyline.begin() + i + 1);
+    }
+
+    return QPoint(x, best_y);
+}
+
+int SkylinePacker::getUsedHeight() const noexcept
+{
+    auto result = 0;
+
+    for(const auto& segment : m_Skyline)
+        result = std::max(result, segment.m_Y);
+
+    return result;
+}
+
+std::optional<int> SkylinePacker::fit(const size_t& segment, const int& width, const int& height) const
+{
+    const auto x = m_Skyline[segment].m_X;
+
+    if(x + width > m_Width)
+        return {};
+
+    // the rectangle rests on the highest segment it spans
+    auto y = 0;
+
+    for(auto i = segment; i < m_Skyline.size() && m_Skyline[i].m_X < x + width; i++)
+        y = std::max(y, m_Skyline[i].m_Y);
+
+    if(y + height > m_Height)
+        return {};
+
+    return y;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QtCore/QPoint>
+
+#include <optional>
+#include <vector>
+
+class SkylinePacker
+{
+    // horizontal run of the skyline, y is the first free row
+    struct Segment
+    {
+        int m_X = 0;
+        int m_Y = 0;
+        int m_Width = 0;
+    };
+
+    using Segments = std::vector<Segment>;
+    using InsertResult = std::optional<QPoint>;
+
+public:
+    SkylinePacker(const int& width, const int& height);
+    ~SkylinePacker();
+
+    // bottom left placement, lowest top edge first, then least wasted width
+    InsertResult insert(const int& width, const int& height);
+
+    int getUsedHeight() const noexcept;
+
+private:
+    std::optional<int> fit(const size_t& segment, const int& width, const int& height) const;
+
+private:
+    int m_Width;
+    int m_Height;
+    Segments m_Skyline;
+};
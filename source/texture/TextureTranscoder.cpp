@@ -0,0 +1,183 @@
+#include "texture/TextureTranscoder.h"
+
+#include "texture/AlphaClassifier.h"
+#include "texture/ImageCache.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QtEndian>
+
+#include <QtGui/QImage>
+
+#include <cstring>
+
+QMutex TextureTranscoder::sm_EntriesMutex = {};
+TextureTranscoder::Entries TextureTranscoder::sm_Entries = {};
+
+TextureTranscoder::TextureTranscoder(const QString& path, const bool& mipmaps) : m_Path{path}, m_Mipmaps{mipmaps}
+{
+}
+
+TextureTranscoder::~TextureTranscoder()
+{
+}
+
+Texture TextureTranscoder::transcode(const Texture& texture)
+{
+    if(texture.m_TextureOrgFile.isEmpty() || texture.m_TextureName.endsWith(".dds"))
+        return texture;
+
+    auto entry = std::shared_ptr<Entry>();
+
+    {
+        QMutexLocker locker(&sm_EntriesMutex);
+
+        auto& cached = sm_Entries[texture.m_TextureOrgFile + (m_Mipmaps ? ":mips" : "")];
+
+        if(!cached)
+            cached = std::make_shared<Entry>();
+
+        entry = cached;
+    }
+
+    std::call_once(entry->m_Encoded, [this, &entry, &texture]() { entry->m_Dds = encode(texture); });
+
+    if(entry->m_Dds.isEmpty())
+        return texture;
+
+    auto result = texture;
+
+    // .ani.png and .png alike become .dds, sub folders of character textures are kept
+    const auto suffix_index = result.m_TextureName.endsWith(".ani.png") ? result.m_TextureName.size() - 8 : result.m_TextureName.size() - 4;
+
+    result.m_TextureName = result.m_TextureName.left(suffix_index) + ".dds";
+    result.m_TextureOrgFile = m_Path + "/" + result.m_TextureName;
+
+    {
+        QMutexLocker locker(&sm_EntriesMutex);
+
+        if(!entry->m_Files.insert(result.m_TextureOrgFile).second)
+            return result;
+    }
+
+    const auto out_dir = QDir(QFileInfo(result.m_TextureOrgFile).absolutePath());
+
+    if(!out_dir.exists())
+        out_dir.mkpath(".");
+
+    QFile file(result.m_TextureOrgFile);
+
+    if(!file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return texture;
+
+    file.write(entry->m_Dds);
+    file.close();
+
+    return result;
+}
+
+Geometry TextureTranscoder::transcode(const Geometry& geometry)
+{
+    auto result = geometry;
+
+    result.m_Texture = transcode(geometry.m_Texture);
+
+    return result;
+}
+
+Level TextureTranscoder::transcode(const Level& level)
+{
+    auto result = level;
+
+    for(auto& trile : result.m_TrileGeometries)
+        trile.second.m_Texture = transcode(trile.second.m_Texture);
+
+    for(auto& ao : result.m_ArtObjectGeometries)
+        ao.second.m_Texture = transcode(ao.second.m_Texture);
+
+    for(auto& bp : result.m_BackgroundPlanes)
+        bp.m_Geometry.m_Texture = transcode(bp.m_Geometry.m_Texture);
+
+    for(auto& car : result.m_Characters)
+        car.m_Geometry.m_Texture = transcode(car.m_Geometry.m_Texture);
+
+    for(auto& geometry : result.m_BakedGeometries)
+        geometry.m_Texture = transcode(geometry.m_Texture);
+
+    return result;
+}
+
+QByteArray TextureTranscoder::encode(const Texture& texture) const
+{
+    const auto image = ImageCache::image(texture.m_TextureOrgFile);
+
+    if(image.isNull())
+        return {};
+
+    const auto alpha = texture.m_Alpha != TextureAlpha::Unknown ? texture.m_Alpha : AlphaClassifier::classify(image);
+    const auto format = alpha == TextureAlpha::Opaque ? BlockCompressor::Format::Bc1 : BlockCompressor::Format::Bc3;
+
+    // nearest neighbour pixel art keeps only the top level unless mips are asked for
+    auto levels = std::vector<QByteArray>{BlockCompressor::compress(image, format)};
+
+    if(m_Mipmaps)
+    {
+        auto mip = image;
+
+        while(mip.width() > 1 || mip.height() > 1)
+        {
+            mip = mip.scaled(std::max(mip.width() / 2, 1), std::max(mip.height() / 2, 1), Qt::AspectRatioMode::IgnoreAspectRatio,
+                             Qt::TransformationMode::SmoothTransformation);
+            levels.push_back(BlockCompressor::compress(mip, format));
+        }
+    }
+
+    auto result = ddsHeader(image.width(), image.height(), int(levels.size()), format, size_t(levels.front().size()));
+
+    for(const auto& level : levels)
+        result.append(level);
+
+    return result;
+}
+
+QByteArray TextureTranscoder::ddsHeader(const int& width, const int& height, const int& levels, const BlockCompressor::Format& format,
+                                        const size_t& topLevelSize)
+{
+    // "DDS " and the 124 byte DDS_HEADER with a DXT1 / DXT5 four cc pixel format
+    static constexpr auto dds_caps = 0x1;
+    static constexpr auto dds_height = 0x2;
+    static constexpr auto dds_width = 0x4;
+    static constexpr auto dds_pixel_format = 0x1000;
+    static constexpr auto dds_mip_map_count = 0x20000;
+    static constexpr auto dds_linear_size = 0x80000;
+
+    static constexpr auto ddpf_four_cc = 0x4;
+
+    static constexpr auto dds_caps_complex = 0x8;
+    static constexpr auto dds_caps_texture = 0x1000;
+    static constexpr auto dds_caps_mip_map = 0x400000;
+
+    auto result = QByteArray(128, '\0');
+    const auto dst = result.data();
+
+    const auto has_mips = levels > 1;
+
+    std::memcpy(dst, "DDS ", 4);
+    qToLittleEndian<quint32>(124, dst + 4);
+    qToLittleEndian<quint32>(dds_caps | dds_height | dds_width | dds_pixel_format | dds_linear_size | (has_mips ? dds_mip_map_count : 0), dst + 8);
+    qToLittleEndian<quint32>(quint32(height), dst + 12);
+    qToLittleEndian<quint32>(quint32(width), dst + 16);
+    qToLittleEndian<quint32>(quint32(topLevelSize), dst + 20);
+    qToLittleEndian<quint32>(quint32(levels), dst + 28);
+
+    // pixel format at offset 76
+    qToLittleEndian<quint32>(32, dst + 76);
+    qToLittleEndian<quint32>(ddpf_four_cc, dst + 80);
+    std::memcpy(dst + 84, format == BlockCompressor::Format::Bc1 ? "DXT1" : "DXT5", 4);
+
+    qToLittleEndian<quint32>(dds_caps_texture | (has_mips ? dds_caps_complex | dds_caps_mip_map : 0), dst + 108);
+
+    return result;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "model/Geometry.h"
+#include "model/Level.h"
+#include "model/Texture.h"
+
+#include "texture/BlockCompressor.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+class TextureTranscoder
+{
+    struct Entry
+    {
+        std::once_flag m_Encoded;
+        QByteArray m_Dds;
+        std::set<QString> m_Files;
+    };
+
+    using Entries = std::map<QString, std::shared_ptr<Entry>>;
+
+public:
+    TextureTranscoder(const QString& path, const bool& mipmaps = false);
+    ~TextureTranscoder();
+
+    // bc1 for opaque textures, bc3 for cutout and translucent ones, written as dds into the export path
+    Texture transcode(const Texture& texture);
+    Geometry transcode(const Geometry& geometry);
+    Level transcode(const Level& level);
+
+private:
+    QByteArray encode(const Texture& texture) const;
+
+    static QByteArray ddsHeader(const int& width, const int& height, const int& levels, const BlockCompressor::Format& format, const size_t& topLevelSize);
+
+private:
+    QString m_Path;
+    bool m_Mipmaps;
+
+    // encoded once per source file and mip setting, every export folder gets a copy
+    static QMutex sm_EntriesMutex;
+    static Entries sm_Entries;
+};
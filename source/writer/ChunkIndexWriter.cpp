@@ -0,0 +1,53 @@
+#include "writer/ChunkIndexWriter.h"
+#include "writer/LodIndexWriter.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+ChunkIndexWriter::ChunkIndexWriter(const QString& path) : m_Path{path}
+{
+    QDir dir(m_Path);
+
+    if(!dir.exists())
+        dir.mkpath(".");
+}
+
+void ChunkIndexWriter::writeIndex(const QString& levelName, const int& chunkSize, const LevelChunker::Chunks& chunks, const QStringList& extensions)
+{
+    const auto to_array = [](const auto& v) -> QJsonArray { return QJsonArray{v.x(), v.y(), v.z()}; };
+
+    auto json_chunks = QJsonArray();
+
+    for(const auto& chunk : chunks)
+    {
+        auto files = QJsonArray();
+
+        for(const auto& extension : extensions)
+            files.append(chunk.m_Level.m_LevelName + "." + extension);
+
+        auto json_chunk = QJsonObject{{"name", chunk.m_Level.m_LevelName},
+                                      {"cell", to_array(chunk.m_Cell)},
+                                      {"morton", QString::number(chunk.m_MortonCode)},
+                                      {"min", to_array(chunk.m_Min)},
+                                      {"max", to_array(chunk.m_Max)},
+                                      {"files", files}};
+
+        if(!chunk.m_Lods.empty())
+            json_chunk["lods"] = LodIndexWriter::toJson(chunk.m_Lods, extensions);
+
+        json_chunks.append(json_chunk);
+    }
+
+    const auto index = QJsonObject{{"level", levelName}, {"chunkSize", chunkSize}, {"chunks", json_chunks}};
+
+    QFile file(m_Path + "/" + levelName + "_chunks.json");
+
+    if(!file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return;
+
+    file.write(QJsonDocument(index).toJson(QJsonDocument::JsonFormat::Indented));
+    file.close();
+}
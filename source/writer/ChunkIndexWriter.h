@@ -0,0 +1,18 @@
+#pragma once
+
+#include "processor/LevelChunker.h"
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+class ChunkIndexWriter
+{
+public:
+    ChunkIndexWriter(const QString& path);
+
+    // writes <level>_chunks.json, every chunk lists one file per extension
+    void writeIndex(const QString& levelName, const int& chunkSize, const LevelChunker::Chunks& chunks, const QStringList& extensions);
+
+private:
+    QString m_Path;
+};
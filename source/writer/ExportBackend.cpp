@@ -0,0 +1,21 @@
+#include "writer/ExportBackend.h"
+
+#include "writer/GlbBackend.h"
+#include "writer/ObjBackend.h"
+#include "writer/StatsBackend.h"
+
+ExportBackends ExportBackend::create(const ExportSettings& settings)
+{
+    auto result = ExportBackends();
+
+    if(settings.m_WriteObj)
+        result.push_back(std::make_shared<ObjBackend>());
+
+    if(settings.m_WriteGlb)
+        result.push_back(std::make_shared<GlbBackend>(settings.m_QuantizeGlb));
+
+    if(settings.m_WriteStats)
+        result.push_back(std::make_shared<StatsBackend>());
+
+    return result;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ExportSettings.h"
+
+#include "model/Geometry.h"
+#include "model/Level.h"
+#include "model/LevelAnalysis.h"
+
+#include <QtCore/QString>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+class ExportBackend;
+
+using ExportBackends = std::vector<std::shared_ptr<const ExportBackend>>;
+
+// one output format, every backend gets the same parsed and processed data
+// backends keep no state between calls so one set of them serves all export jobs
+class ExportBackend
+{
+public:
+    using Triles = std::map<int, Geometry>;
+
+    virtual ~ExportBackend() = default;
+
+    virtual void writeGeometry(const QString& path, const Geometry& geometry) const = 0;
+    virtual void writeTrileSet(const QString& path, const QString& setName, const Triles& triles) const = 0;
+    virtual void writeLevel(const QString& path, const Level& level, const LevelAnalysis& analysis) const = 0;
+
+    // one backend per format selected in the settings
+    static ExportBackends create(const ExportSettings& settings);
+};
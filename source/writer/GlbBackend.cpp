@@ -0,0 +1,25 @@
+#include "writer/GlbBackend.h"
+
+#include "writer/GlbWriter.h"
+
+GlbBackend::GlbBackend(const bool& quantize) : m_Quantize{quantize}
+{
+}
+
+void GlbBackend::writeGeometry(const QString& path, const Geometry& geometry) const
+{
+    GlbWriter(path, m_Quantize).writeGeometry(geometry);
+}
+
+void GlbBackend::writeTrileSet(const QString& path, const QString& setName, const Triles& triles) const
+{
+    GlbWriter(path, m_Quantize).writeTrileSet(setName, triles);
+}
+
+void GlbBackend::writeLevel(const QString& path, const Level& level, const LevelAnalysis& analysis) const
+{
+    if(analysis.m_Batched)
+        GlbWriter(path, m_Quantize).writeBatches(level.m_LevelName, analysis.m_Batches);
+    else
+        GlbWriter(path, m_Quantize).writeLevel(level.m_LevelName, analysis.m_InstanceGroups);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "writer/ExportBackend.h"
+
+class GlbBackend : public ExportBackend
+{
+public:
+    GlbBackend(const bool& quantize);
+
+    void writeGeometry(const QString& path, const Geometry& geometry) const override;
+    void writeTrileSet(const QString& path, const QString& setName, const Triles& triles) const override;
+    void writeLevel(const QString& path, const Level& level, const LevelAnalysis& analysis) const override;
+
+private:
+    bool m_Quantize;
+};
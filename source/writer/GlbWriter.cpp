@@ -0,0 +1,551 @@
+#include "writer/GlbWriter.h"
+
+#include "processor/LevelBatcher.h"
+
+#include "profiling/Trace.h"
+
+#include "texture/AlphaClassifier.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QUrl>
+#include <QtCore/QtEndian>
+
+#include <cmath>
+#include <limits>
+
+static constexpr auto gl_byte = 5120;
+static constexpr auto gl_short = 5122;
+static constexpr auto gl_unsigned_short = 5123;
+static constexpr auto gl_unsigned_int = 5125;
+static constexpr auto gl_float = 5126;
+
+static constexpr auto gl_array_buffer = 34962;
+static constexpr auto gl_element_array_buffer = 34963;
+
+static constexpr auto gl_nearest = 9728;
+
+template<typename T>
+static void writeValue(char* dst, const T& value)
+{
+    qToLittleEndian<T>(value, dst);
+}
+
+static QJsonArray toJsonArray(const Vec3f& v)
+{
+    return {v.x(), v.y(), v.z()};
+}
+
+static QJsonArray toJsonArray(const QuaternionF& q)
+{
+    return {q.x(), q.y(), q.z(), q.w()};
+}
+
+GlbWriter::GlbWriter(const QString& path, const bool& quantize) :
+    m_Path{path}, m_SaveName{}, m_Quantize{quantize}, m_UsesInstancing{false}, m_UsesQuantization{false}, m_UsesDds{false}, m_Buffer{}
+{
+    // make path
+    QDir dir(m_Path);
+
+    if(!dir.exists())
+        dir.mkpath(".");
+}
+
+void GlbWriter::writeGeometry(const Geometry& geometry)
+{
+    m_SaveName = geometry.m_Name;
+
+    const auto mesh = addGeometry(geometry.m_Name, geometry);
+
+    if(!mesh)
+        return;
+
+    addNode(geometry.m_Name, *mesh, {{Vec3f::Zero(), QuaternionF::Identity(), Vec3f::Ones()}});
+
+    save();
+}
+
+void GlbWriter::writeTrileSet(const QString& setName, const std::map<int, Geometry>& triles)
+{
+    m_SaveName = setName;
+
+    // one node per trile key, materials and the texture are shared
+    for(const auto& trile : triles)
+    {
+        const auto mesh = addGeometry("trile:" + QString::number(trile.first), trile.second);
+
+        if(!mesh)
+            continue;
+
+        addNode(trile.second.m_Name, *mesh, {{Vec3f::Zero(), QuaternionF::Identity(), Vec3f::Ones()}});
+    }
+
+    save();
+}
+
+void GlbWriter::writeLevel(const QString& levelName, const InstanceGroups& groups)
+{
+    m_SaveName = levelName;
+
+    addInstanceGroups(groups);
+
+    save();
+}
+
+void GlbWriter::writeBatches(const QString& levelName, const LevelAnalysis::Batches& batches)
+{
+    m_SaveName = levelName;
+
+    for(const auto& batch : batches)
+    {
+        const auto mesh = addGeometry(batch.m_Name + ":" + LevelBatcher::materialKey(batch), batch);
+
+        if(!mesh)
+            continue;
+
+        addNode(batch.m_Name, *mesh, {{Vec3f::Zero(), QuaternionF::Identity(), Vec3f::Ones()}});
+    }
+
+    save();
+}
+
+GlbWriter::MeshId GlbWriter::addGeometry(const QString& key, const Geometry& geometry)
+{
+    TraceSpan span("add geometry", geometry.m_Name, ProfileStage::SceneBuild);
+
+    const auto mesh_find_iter = m_MeshIds.find(key);
+
+    if(mesh_find_iter != m_MeshIds.cend())
+        return mesh_find_iter->second;
+
+    const auto num_vertices = geometry.m_Vertices.size();
+    const auto num_faces = geometry.m_Indices.size() / 3;
+
+    if(num_vertices == 0 || num_faces == 0)
+        return {};
+
+    // bounds
+    auto min = Vec3f::Constant(std::numeric_limits<float>::max()).eval();
+    auto max = Vec3f::Constant(std::numeric_limits<float>::lowest()).eval();
+    auto uv_in_unit_range = true;
+
+    for(const auto& v : geometry.m_Vertices)
+    {
+        const auto& t = v.m_TextureCoordinate;
+
+        min = min.cwiseMin(v.m_Position);
+        max = max.cwiseMax(v.m_Position);
+
+        uv_in_unit_range = uv_in_unit_range && t.x() >= 0.0f && t.x() <= 1.0f && t.y() >= 0.0f && t.y() <= 1.0f;
+    }
+
+    // KHR_mesh_quantization: positions as short with a uniform scale that is folded into the node / instance scale,
+    // normals as normalized byte, texture coordinates as normalized unsigned short if they stay in [0, 1]
+    const auto quantize = m_Quantize;
+    const auto quantize_uv = m_Quantize && uv_in_unit_range;
+    const auto max_abs = std::max(min.cwiseAbs().maxCoeff(), max.cwiseAbs().maxCoeff());
+    const auto scale = quantize && max_abs > 0.0f ? max_abs / 32767.0f : 1.0f;
+
+    m_UsesQuantization = m_UsesQuantization || quantize;
+
+    // interleaved vertex layout, every attribute is 4 byte aligned
+    const auto position_size = quantize ? 8 : 12;
+    const auto normal_size = quantize ? 4 : 12;
+    const auto uv_size = quantize_uv ? 4 : 8;
+    const auto normal_offset = position_size;
+    const auto uv_offset = normal_offset + normal_size;
+    const auto stride = uv_offset + uv_size;
+
+    auto vertex_data = QByteArray(qsizetype(num_vertices * stride), '\0');
+
+    for(size_t i = 0; i < num_vertices; i++)
+    {
+        const auto& v = geometry.m_Vertices[i];
+        const auto& p = v.m_Position;
+        const auto& n = v.m_Normal;
+        const auto& t = v.m_TextureCoordinate;
+
+        const auto dst = vertex_data.data() + i * stride;
+
+        // gltf has its texture origin in the upper left corner
+        const auto u = t.x();
+        const auto w = 1.0f - t.y();
+
+        for(int c = 0; c < 3; c++)
+        {
+            if(quantize)
+            {
+                writeValue<qint16>(dst + c * 2, qint16(std::lround(p[c] / scale)));
+                writeValue<qint8>(dst + normal_offset + c, qint8(std::lround(n[c] * 127.0f)));
+            }
+            else
+            {
+                writeValue<float>(dst + c * 4, p[c]);
+                writeValue<float>(dst + normal_offset + c * 4, n[c]);
+            }
+        }
+
+        if(quantize_uv)
+        {
+            writeValue<quint16>(dst + uv_offset + 0, quint16(std::lround(u * 65535.0f)));
+            writeValue<quint16>(dst + uv_offset + 2, quint16(std::lround(w * 65535.0f)));
+        }
+        else
+        {
+            writeValue<float>(dst + uv_offset + 0, u);
+            writeValue<float>(dst + uv_offset + 4, w);
+        }
+    }
+
+    // index data, same winding as the obj export
+    const auto use_short_indices = num_vertices <= 0xFFFF;
+    const auto index_size = use_short_indices ? 2 : 4;
+
+    auto index_data = QByteArray(qsizetype(num_faces * 3 * index_size), '\0');
+
+    for(size_t i = 0; i < num_faces; i++)
+    {
+        const unsigned int face[3] = {(unsigned int)geometry.m_Indices[3 * i + 0],  //
+                                      (unsigned int)geometry.m_Indices[3 * i + 2],  //
+                                      (unsigned int)geometry.m_Indices[3 * i + 1]};
+
+        for(int c = 0; c < 3; c++)
+        {
+            const auto dst = index_data.data() + (3 * i + c) * index_size;
+
+            if(use_short_indices)
+                writeValue<quint16>(dst, quint16(face[c]));
+            else
+                writeValue<quint32>(dst, face[c]);
+        }
+    }
+
+    // accessors
+    const auto vertex_view = addBufferView(vertex_data, stride, gl_array_buffer);
+    const auto index_view = addBufferView(index_data, 0, gl_element_array_buffer);
+
+    const auto quantized_bound = [&scale](const Vec3f& v) -> QJsonArray {
+        return {qint64(std::lround(v.x() / scale)), qint64(std::lround(v.y() / scale)), qint64(std::lround(v.z() / scale))};
+    };
+
+    const auto position_min = quantize ? quantized_bound(min) : toJsonArray(min);
+    const auto position_max = quantize ? quantized_bound(max) : toJsonArray(max);
+
+    const auto position_accessor = addAccessor(vertex_view, 0, quantize ? gl_short : gl_float, num_vertices, "VEC3", false, position_min, position_max);
+    const auto normal_accessor = addAccessor(vertex_view, normal_offset, quantize ? gl_byte : gl_float, num_vertices, "VEC3", quantize);
+    const auto uv_accessor = addAccessor(vertex_view, uv_offset, quantize_uv ? gl_unsigned_short : gl_float, num_vertices, "VEC2", quantize_uv);
+    const auto index_accessor = addAccessor(index_view, 0, use_short_indices ? gl_unsigned_short : gl_unsigned_int, num_faces * 3, "SCALAR");
+
+    // mesh
+    const auto attributes = QJsonObject{{"POSITION", position_accessor}, {"NORMAL", normal_accessor}, {"TEXCOORD_0", uv_accessor}};
+    const auto primitive = QJsonObject{{"attributes", attributes}, {"indices", index_accessor}, {"material", addMaterial(geometry)}};
+
+    m_Meshes.append(QJsonObject{{"name", geometry.m_Name}, {"primitives", QJsonArray{primitive}}});
+
+    const auto result = MeshEntry(int(m_Meshes.size() - 1), scale);
+
+    m_MeshIds.insert({key, result});
+
+    return result;
+}
+
+int GlbWriter::addMaterial(const Geometry& geometry)
+{
+    const auto key = LevelBatcher::materialKey(geometry);
+
+    const auto material_find_iter = m_MaterialIds.find(key);
+
+    if(material_find_iter != m_MaterialIds.cend())
+        return material_find_iter->second;
+
+    auto pbr = QJsonObject{{"baseColorFactor", QJsonArray{1.0, 1.0, 1.0, geometry.m_Opacity}}, {"metallicFactor", 0.0}, {"roughnessFactor", 1.0}};
+
+    if(!geometry.m_Texture.m_TextureName.isEmpty())
+        pbr["baseColorTexture"] = QJsonObject{{"index", addImage(geometry.m_Texture)}};
+
+    auto material = QJsonObject{{"name", geometry.m_Texture.m_TextureName}, {"pbrMetallicRoughness", pbr}, {"doubleSided", geometry.m_DoubleSided}};
+
+    // planes are pixel art sprites, most of them with hard edges
+    const auto alpha = geometry.m_IsPlane && geometry.m_Texture.m_Alpha == TextureAlpha::Unknown ? AlphaClassifier::classify(geometry.m_Texture.m_TextureOrgFile)
+                                                                                                  : geometry.m_Texture.m_Alpha;
+
+    if(geometry.m_Opacity < 1.0f || (geometry.m_IsPlane && alpha == TextureAlpha::Translucent))
+    {
+        material["alphaMode"] = "BLEND";
+    }
+    else if(geometry.m_IsPlane && alpha != TextureAlpha::Opaque)
+    {
+        material["alphaMode"] = "MASK";
+        material["alphaCutoff"] = 0.5;
+    }
+
+    m_Materials.append(material);
+
+    const auto result = int(m_Materials.size() - 1);
+
+    m_MaterialIds.insert({key, result});
+
+    return result;
+}
+
+int GlbWriter::addImage(const Texture& texture)
+{
+    const auto image_find_iter = m_ImageIds.find(texture.m_TextureName);
+
+    if(image_find_iter != m_ImageIds.cend())
+        return image_find_iter->second;
+
+    m_Images.append(QJsonObject{{"uri", QString::fromUtf8(QUrl::toPercentEncoding(texture.m_TextureName, "/"))}});
+
+    // block compressed textures go through MSFT_texture_dds
+    if(texture.m_TextureName.endsWith(".dds"))
+    {
+        m_UsesDds = true;
+        m_GltfTextures.append(QJsonObject{{"sampler", 0}, {"extensions", QJsonObject{{"MSFT_texture_dds", QJsonObject{{"source", int(m_Images.size() - 1)}}}}}});
+    }
+    else
+    {
+        m_GltfTextures.append(QJsonObject{{"sampler", 0}, {"source", int(m_Images.size() - 1)}});
+    }
+
+    m_Textures.push_back(std::make_pair(texture.m_TextureOrgFile, m_Path + "/" + texture.m_TextureName));
+
+    const auto result = int(m_GltfTextures.size() - 1);
+
+    m_ImageIds.insert({texture.m_TextureName, result});
+
+    return result;
+}
+
+int GlbWriter::addBufferView(const QByteArray& data, const int& stride, const int& target)
+{
+    // keep every view 4 byte aligned
+    while(m_Buffer.size() % 4 != 0)
+        m_Buffer.append('\0');
+
+    auto buffer_view = QJsonObject{{"buffer", 0}, {"byteOffset", qint64(m_Buffer.size())}, {"byteLength", qint64(data.size())}};
+
+    if(stride != 0)
+        buffer_view["byteStride"] = stride;
+
+    if(target != 0)
+        buffer_view["target"] = target;
+
+    m_Buffer.append(data);
+    m_BufferViews.append(buffer_view);
+
+    return int(m_BufferViews.size() - 1);
+}
+
+int GlbWriter::addAccessor(const int& bufferView, const int& byteOffset, const int& componentType, const size_t& count, const QString& type,
+                           const bool& normalized, const QJsonArray& min, const QJsonArray& max)
+{
+    auto accessor = QJsonObject{{"bufferView", bufferView},  //
+                                {"byteOffset", byteOffset},
+                                {"componentType", componentType},
+                                {"count", qint64(count)},
+                                {"type", type}};
+
+    if(normalized)
+        accessor["normalized"] = true;
+
+    if(!min.isEmpty() && !max.isEmpty())
+    {
+        accessor["min"] = min;
+        accessor["max"] = max;
+    }
+
+    m_Accessors.append(accessor);
+
+    return int(m_Accessors.size() - 1);
+}
+
+void GlbWriter::addNode(const QString& name, const MeshEntry& mesh, const Instances& instances)
+{
+    if(instances.empty())
+        return;
+
+    const auto& mesh_index = mesh.first;
+    const auto& mesh_scale = mesh.second;
+
+    auto node = QJsonObject{{"name", name}, {"mesh", mesh_index}};
+
+    if(instances.size() == 1)
+    {
+        const auto& [translation, rotation, scale] = instances.front();
+
+        node["translation"] = toJsonArray(translation);
+        node["rotation"] = toJsonArray(rotation);
+        node["scale"] = toJsonArray(scale * mesh_scale);
+
+        m_Nodes.append(node);
+
+        return;
+    }
+
+    // EXT_mesh_gpu_instancing
+    auto translations = QByteArray(qsizetype(instances.size() * 12), '\0');
+    auto rotations = QByteArray(qsizetype(instances.size() * 16), '\0');
+    auto scales = QByteArray(qsizetype(instances.size() * 12), '\0');
+
+    for(size_t i = 0; i < instances.size(); i++)
+    {
+        const auto& [translation, rotation, scale] = instances[i];
+        const auto r = rotation.normalized();
+
+        for(int c = 0; c < 3; c++)
+        {
+            writeValue<float>(translations.data() + i * 12 + c * 4, translation[c]);
+            writeValue<float>(scales.data() + i * 12 + c * 4, scale[c] * mesh_scale);
+        }
+
+        writeValue<float>(rotations.data() + i * 16 + 0, r.x());
+        writeValue<float>(rotations.data() + i * 16 + 4, r.y());
+        writeValue<float>(rotations.data() + i * 16 + 8, r.z());
+        writeValue<float>(rotations.data() + i * 16 + 12, r.w());
+    }
+
+    const auto translation_accessor = addAccessor(addBufferView(translations, 0, 0), 0, gl_float, instances.size(), "VEC3");
+    const auto rotation_accessor = addAccessor(addBufferView(rotations, 0, 0), 0, gl_float, instances.size(), "VEC4");
+    const auto scale_accessor = addAccessor(addBufferView(scales, 0, 0), 0, gl_float, instances.size(), "VEC3");
+
+    const auto attributes = QJsonObject{{"TRANSLATION", translation_accessor}, {"ROTATION", rotation_accessor}, {"SCALE", scale_accessor}};
+
+    node["extensions"] = QJsonObject{{"EXT_mesh_gpu_instancing", QJsonObject{{"attributes", attributes}}}};
+
+    m_Nodes.append(node);
+
+    m_UsesInstancing = true;
+}
+
+void GlbWriter::addInstanceGroups(const InstanceGroups& groups)
+{
+    for(const auto& group : groups)
+    {
+        const auto mesh = addGeometry(group.first, *group.second.m_Geometry);
+
+        if(!mesh)
+            continue;
+
+        addNode(group.second.m_Name, *mesh, group.second.m_Instances);
+    }
+}
+
+void GlbWriter::save()
+{
+    TraceSpan span("glb export", m_SaveName, ProfileStage::Export);
+
+    // json chunk
+    auto scene_nodes = QJsonArray();
+
+    for(qsizetype i = 0; i < m_Nodes.size(); i++)
+        scene_nodes.append(int(i));
+
+    auto gltf = QJsonObject{{"asset", QJsonObject{{"version", "2.0"}, {"generator", "FezModelGenerator"}}},
+                            {"scene", 0},
+                            {"scenes", QJsonArray{QJsonObject{{"name", m_SaveName}, {"nodes", scene_nodes}}}},
+                            {"nodes", m_Nodes}};
+
+    if(!m_Meshes.isEmpty())
+    {
+        gltf["meshes"] = m_Meshes;
+        gltf["accessors"] = m_Accessors;
+        gltf["bufferViews"] = m_BufferViews;
+        gltf["buffers"] = QJsonArray{QJsonObject{{"byteLength", qint64(m_Buffer.size())}}};
+    }
+
+    if(!m_Materials.isEmpty())
+        gltf["materials"] = m_Materials;
+
+    if(!m_Images.isEmpty())
+    {
+        gltf["images"] = m_Images;
+        gltf["textures"] = m_GltfTextures;
+        gltf["samplers"] = QJsonArray{QJsonObject{{"magFilter", gl_nearest}, {"minFilter", gl_nearest}}};
+    }
+
+    auto extensions_used = QJsonArray();
+    auto extensions_required = QJsonArray();
+
+    if(m_UsesInstancing)
+    {
+        extensions_used.append("EXT_mesh_gpu_instancing");
+        extensions_required.append("EXT_mesh_gpu_instancing");
+    }
+
+    if(m_UsesQuantization)
+    {
+        extensions_used.append("KHR_mesh_quantization");
+        extensions_required.append("KHR_mesh_quantization");
+    }
+
+    if(m_UsesDds)
+    {
+        extensions_used.append("MSFT_texture_dds");
+        extensions_required.append("MSFT_texture_dds");
+    }
+
+    if(!extensions_used.isEmpty())
+    {
+        gltf["extensionsUsed"] = extensions_used;
+        gltf["extensionsRequired"] = extensions_required;
+    }
+
+    auto json = QJsonDocument(gltf).toJson(QJsonDocument::JsonFormat::Compact);
+
+    while(json.size() % 4 != 0)
+        json.append(' ');
+
+    while(m_Buffer.size() % 4 != 0)
+        m_Buffer.append('\0');
+
+    // glb container
+    const auto has_bin_chunk = !m_Buffer.isEmpty();
+    const auto total_size = 12 + 8 + json.size() + (has_bin_chunk ? 8 + m_Buffer.size() : 0);
+
+    auto header = QByteArray(12, '\0');
+    writeValue<quint32>(header.data() + 0, 0x46546C67);  // glTF
+    writeValue<quint32>(header.data() + 4, 2);
+    writeValue<quint32>(header.data() + 8, quint32(total_size));
+
+    auto json_chunk_header = QByteArray(8, '\0');
+    writeValue<quint32>(json_chunk_header.data() + 0, quint32(json.size()));
+    writeValue<quint32>(json_chunk_header.data() + 4, 0x4E4F534A);  // JSON
+
+    auto bin_chunk_header = QByteArray(8, '\0');
+    writeValue<quint32>(bin_chunk_header.data() + 0, quint32(m_Buffer.size()));
+    writeValue<quint32>(bin_chunk_header.data() + 4, 0x004E4942);  // BIN
+
+    QFile file(m_Path + "/" + m_SaveName + ".glb");
+
+    if(!file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return;
+
+    file.write(header);
+    file.write(json_chunk_header);
+    file.write(json);
+
+    if(has_bin_chunk)
+    {
+        file.write(bin_chunk_header);
+        file.write(m_Buffer);
+    }
+
+    file.close();
+
+    for(const auto& t : m_Textures)
+    {
+        const auto texture_out_dir = QDir(QFileInfo(t.second).absolutePath());
+
+        if(!texture_out_dir.exists())
+            texture_out_dir.mkdir(".");
+
+        TraceSpan copy_span("copy texture", t.first, ProfileStage::TextureCopy);
+
+        QFile texture(t.first);
+        texture.copy(t.second);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "model/Geometry.h"
+#include "model/LevelAnalysis.h"
+
+#include "math/Quaternion.h"
+#include "math/Vector.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonArray>
+#include <QtCore/QString>
+
+#include <map>
+
+class GlbWriter
+{
+    using Textures = std::vector<std::pair<QString, QString>>;
+
+    // mesh index and the uniform scale that dequantizes its positions
+    using MeshEntry = std::pair<int, float>;
+    using MeshId = std::optional<MeshEntry>;
+
+public:
+    GlbWriter(const QString& path, const bool& quantize = false);
+
+    void writeGeometry(const Geometry& geometry);
+    void writeTrileSet(const QString& setName, const std::map<int, Geometry>& triles);
+    void writeLevel(const QString& levelName, const InstanceGroups& groups);
+    void writeBatches(const QString& levelName, const LevelAnalysis::Batches& batches);
+
+private:
+    MeshId addGeometry(const QString& key, const Geometry& geometry);
+    int addMaterial(const Geometry& geometry);
+    int addImage(const Texture& texture);
+    int addBufferView(const QByteArray& data, const int& stride, const int& target);
+    int addAccessor(const int& bufferView, const int& byteOffset, const int& componentType, const size_t& count, const QString& type,
+                    const bool& normalized = false, const QJsonArray& min = {}, const QJsonArray& max = {});
+    void addNode(const QString& name, const MeshEntry& mesh, const Instances& instances);
+    void addInstanceGroups(const InstanceGroups& groups);
+
+    void save();
+
+private:
+    QString m_Path;
+    QString m_SaveName;
+
+    bool m_Quantize;
+    bool m_UsesInstancing;
+    bool m_UsesQuantization;
+    bool m_UsesDds;
+
+    QByteArray m_Buffer;
+
+    QJsonArray m_BufferViews;
+    QJsonArray m_Accessors;
+    QJsonArray m_Meshes;
+    QJsonArray m_Materials;
+    QJsonArray m_GltfTextures;
+    QJsonArray m_Images;
+    QJsonArray m_Nodes;
+
+    std::map<QString, MeshEntry> m_MeshIds;
+    std::map<QString, int> m_MaterialIds;
+    std::map<QString, int> m_ImageIds;
+
+    Textures m_Textures;
+};
@@ -1,5 +1,7 @@
 #include "writer/LevelWriter.h"
 
+#include "math/Orientation.h"
+
 #include <QtCore/QFile>
 #include <QtCore/QDir>
 
@@ -64,16 +66,8 @@ void LevelWriter::writeLevel(const Level& level)
 
         aiVector3D pos = aiVector3D(te.m_Position.x(), te.m_Position.y(), te.m_Position.z());
         aiVector3D sca = aiVector3D(1.0f, 1.0f, 1.0f);
-        aiQuaternion rot = [](const auto& orientation) {
-            switch(orientation)
-            {
-                case 0: return aiQuaternion(M_PI, 0.0f, 0.0f);
-                case 1: return aiQuaternion(M_PI * -0.5f, 0.0f, 0.0f);
-                case 2: return aiQuaternion(0.0f, 0.0f, 0.0f);
-                case 3: return aiQuaternion(M_PI * 0.5f, 0.0f, 0.0f);
-                default: return aiQuaternion();
-            }
-        }(te.m_Orintation);
+        const auto& orientation = trileOrientation(te.m_Orintation);
+        aiQuaternion rot = aiQuaternion(orientation.w(), orientation.x(), orientation.y(), orientation.z());
 
         node->mTransformation = aiMatrix4x4(sca, rot, pos);
 
@@ -135,5 +129,58 @@ void LevelWriter::writeLevel(const Level& level)
         m_Scene->mRootNode->addChildren(1, nodes);
     }
 
+    // baked geometries are already in world space
+    for(const auto& geometry : level.m_BakedGeometries)
+    {
+        const auto mesh_id = addGeometry(geometry);
+
+        if(!mesh_id)
+            continue;
+
+        const auto nodes = new aiNode*[1];
+        nodes[0] = new aiNode;
+        const auto node = nodes[0];
+
+        node->mName = geometry.m_Name.toStdString();
+        node->mMeshes = new unsigned int[1];
+        node->mMeshes[0] = *mesh_id;
+        node->mNumMeshes = 1;
+
+        m_Scene->mRootNode->addChildren(1, nodes);
+    }
+
     save();
 }
+
+
+void LevelWriter::writeBatches(const QString& levelName, const LevelAnalysis::Batches& batches)
+{
+    m_SaveName = levelName;
+
+    for(const auto& batch : batches)
+    {
+        const auto mesh_id = addGeometry(batch);
+
+        if(!mesh_id)
+            continue;
+
+        const auto nodes = new aiNode*[1];
+        nodes[0] = new aiNode;
+        const auto node = nodes[0];
+
+        aiVector3D pos = aiVector3D(0.0f, 0.0f, 0.0f);
+        aiVector3D sca = aiVector3D(1.0f, 1.0f, 1.0f);
+        aiQuaternion rot = aiQuaternion();
+
+        node->mTransformation = aiMatrix4x4(sca, rot, pos);
+
+        node->mName = batch.m_Name.toStdString();
+        node->mMeshes = new unsigned int[1];
+        node->mMeshes[0] = *mesh_id;
+        node->mNumMeshes = 1;
+
+        m_Scene->mRootNode->addChildren(1, nodes);
+    }
+
+    save();
+}
\ No newline at end of file
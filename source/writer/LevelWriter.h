@@ -1,6 +1,7 @@
 #pragma once
 
 #include "model/Level.h"
+#include "model/LevelAnalysis.h"
 
 #include "writer/Writer.h"
 
@@ -10,4 +11,5 @@ public:
     using Writer::Writer;
 
     void writeLevel(const Level& level);
+    void writeBatches(const QString& levelName, const LevelAnalysis::Batches& batches);
 };
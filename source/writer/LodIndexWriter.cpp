@@ -0,0 +1,50 @@
+#include "writer/LodIndexWriter.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+LodIndexWriter::LodIndexWriter(const QString& path) : m_Path{path}
+{
+    QDir dir(m_Path);
+
+    if(!dir.exists())
+        dir.mkpath(".");
+}
+
+void LodIndexWriter::writeIndex(const QString& name, const size_t& triangles, const Lods& lods, const QStringList& extensions)
+{
+    const auto index = QJsonObject{{"name", name}, {"triangles", qint64(triangles)}, {"lods", toJson(lods, extensions)}};
+
+    QFile file(m_Path + "/" + name + "_lods.json");
+
+    if(!file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return;
+
+    file.write(QJsonDocument(index).toJson(QJsonDocument::JsonFormat::Indented));
+    file.close();
+}
+
+QJsonArray LodIndexWriter::toJson(const Lods& lods, const QStringList& extensions)
+{
+    auto result = QJsonArray();
+
+    for(size_t i = 0; i < lods.size(); i++)
+    {
+        const auto& lod = lods[i];
+
+        auto files = QJsonArray();
+
+        for(const auto& extension : extensions)
+            files.append(lod.m_Name + "." + extension);
+
+        result.append(QJsonObject{{"level", qint64(i + 1)},
+                                  {"name", lod.m_Name},
+                                  {"files", files},
+                                  {"triangles", qint64(lod.m_Triangles)},
+                                  {"error", double(lod.m_Error)}});
+    }
+
+    return result;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "model/Lod.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+class LodIndexWriter
+{
+public:
+    LodIndexWriter(const QString& path);
+
+    // writes <name>_lods.json next to the full detail export
+    void writeIndex(const QString& name, const size_t& triangles, const Lods& lods, const QStringList& extensions);
+
+    // the error is in object units, a renderer switches once error * viewport height / (2 * distance * tan(fov / 2)) is below its pixel threshold
+    static QJsonArray toJson(const Lods& lods, const QStringList& extensions);
+
+private:
+    QString m_Path;
+};
@@ -0,0 +1,24 @@
+#include "writer/ObjBackend.h"
+
+#include "writer/GeometryWriter.h"
+#include "writer/LevelWriter.h"
+#include "writer/TrileSetWriter.h"
+
+void ObjBackend::writeGeometry(const QString& path, const Geometry& geometry) const
+{
+    GeometryWriter(path).writeObj(geometry);
+}
+
+void ObjBackend::writeTrileSet(const QString& path, const QString& setName, const Triles& triles) const
+{
+    TrileSetWriter(path).writeSet(setName, triles);
+}
+
+void ObjBackend::writeLevel(const QString& path, const Level& level, const LevelAnalysis& analysis) const
+{
+    // obj has no instancing, unbatched levels keep one node per placement
+    if(analysis.m_Batched)
+        LevelWriter(path).writeBatches(level.m_LevelName, analysis.m_Batches);
+    else
+        LevelWriter(path).writeLevel(level);
+}
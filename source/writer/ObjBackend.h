@@ -0,0 +1,11 @@
+#pragma once
+
+#include "writer/ExportBackend.h"
+
+class ObjBackend : public ExportBackend
+{
+public:
+    void writeGeometry(const QString& path, const Geometry& geometry) const override;
+    void writeTrileSet(const QString& path, const QString& setName, const Triles& triles) const override;
+    void writeLevel(const QString& path, const Level& level, const LevelAnalysis& analysis) const override;
+};
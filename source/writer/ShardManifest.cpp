@@ -0,0 +1,180 @@
+#include "writer/ShardManifest.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutexLocker>
+
+#include <algorithm>
+
+QMutex ShardManifest::sm_JobsMutex = {};
+ShardManifest::Jobs ShardManifest::sm_Jobs = {};
+
+namespace
+{
+    QJsonObject readJson(const QString& file)
+    {
+        QFile json_file(file);
+
+        if(!json_file.open(QIODevice::OpenModeFlag::ReadOnly))
+            return {};
+
+        return QJsonDocument::fromJson(json_file.readAll()).object();
+    }
+
+    bool writeJson(const QString& file, const QJsonObject& json)
+    {
+        QFile json_file(file);
+
+        if(!json_file.open(QIODevice::OpenModeFlag::WriteOnly))
+            return false;
+
+        json_file.write(QJsonDocument(json).toJson(QJsonDocument::JsonFormat::Indented));
+        json_file.close();
+
+        return true;
+    }
+}
+
+ShardManifest::Timer::Timer(const QString& category, const QString& name) : m_Category{category}, m_Name{name}
+{
+    m_Timer.start();
+}
+
+ShardManifest::Timer::~Timer()
+{
+    const auto seconds = double(m_Timer.nsecsElapsed()) * 1e-9;
+
+    QMutexLocker locker(&sm_JobsMutex);
+
+    sm_Jobs[m_Category][m_Name] += seconds;
+}
+
+QString ShardManifest::shardPath(const QString& path, const Shard& shard)
+{
+    return path + "/shards/" + shard.name();
+}
+
+bool ShardManifest::write(const QString& path, const Shard& shard, const double& seconds)
+{
+    const auto shard_path = shardPath(path, shard);
+
+    if(!QDir(shard_path).mkpath("."))
+        return false;
+
+    auto manifest = QJsonObject{{"shard", shard.m_Index}, {"shards", shard.m_Count}, {"seconds", seconds}};
+
+    QMutexLocker locker(&sm_JobsMutex);
+
+    for(const auto& category : sm_Jobs)
+    {
+        auto jobs = QJsonArray();
+
+        for(const auto& job : category.second)
+            jobs.append(QJsonObject{{"name", job.first}, {"seconds", job.second}});
+
+        manifest.insert(category.first, jobs);
+    }
+
+    return writeJson(shard_path + "/manifest.json", manifest);
+}
+
+bool ShardManifest::merge(const QString& path, const int& count)
+{
+    auto shards = QJsonArray();
+    auto categories = std::map<QString, QJsonArray>();
+
+    auto wall_seconds = 0.0;
+    auto job_seconds = 0.0;
+
+    // dedupe savings add up, aliases are qualified with their set or level and every asset belongs to one shard, so they never collide
+    auto dedupe_categories = QJsonObject();
+    auto dedupe_meshes = qint64(0);
+    auto dedupe_bytes = qint64(0);
+    auto has_dedupe = false;
+
+    for(int i = 1; i <= count; i++)
+    {
+        const auto shard_path = shardPath(path, Shard{i, count});
+        const auto manifest = readJson(shard_path + "/manifest.json");
+
+        if(manifest.isEmpty() || manifest["shards"].toInt() != count)
+        {
+            qDebug() << "Error: no manifest for shard " << i << "/" << count << " in " << shard_path;
+            return false;
+        }
+
+        const auto seconds = manifest["seconds"].toDouble();
+        auto shard_jobs = 0;
+        auto shard_job_seconds = 0.0;
+
+        for(const auto& category : manifest.keys())
+        {
+            if(!manifest[category].isArray())
+                continue;
+
+            for(const auto& job : manifest[category].toArray())
+            {
+                auto merged_job = job.toObject();
+                merged_job.insert("shard", i);
+
+                categories[category].append(merged_job);
+
+                shard_jobs++;
+                shard_job_seconds += merged_job.value("seconds").toDouble();
+            }
+        }
+
+        shards.append(QJsonObject{{"shard", i}, {"seconds", seconds}, {"jobs", shard_jobs}, {"jobSeconds", shard_job_seconds}});
+
+        wall_seconds = std::max(wall_seconds, seconds);
+        job_seconds += shard_job_seconds;
+
+        const auto dedupe = readJson(shard_path + "/dedupe_report.json");
+
+        if(dedupe.isEmpty())
+            continue;
+
+        has_dedupe = true;
+        dedupe_meshes += dedupe["meshes"].toInteger();
+        dedupe_bytes += dedupe["bytesSaved"].toInteger();
+
+        const auto shard_categories = dedupe["categories"].toObject();
+
+        for(const auto& category : shard_categories.keys())
+        {
+            const auto savings = shard_categories[category].toObject();
+            auto merged = dedupe_categories[category].toObject();
+            auto aliases = merged["aliases"].toObject();
+
+            const auto shard_aliases = savings["aliases"].toObject();
+
+            for(const auto& alias : shard_aliases.keys())
+                aliases.insert(alias, shard_aliases[alias]);
+
+            merged["meshes"] = merged.value("meshes").toInteger() + savings["meshes"].toInteger();
+            merged["bytesSaved"] = merged.value("bytesSaved").toInteger() + savings["bytesSaved"].toInteger();
+            merged["aliases"] = aliases;
+
+            dedupe_categories[category] = merged;
+        }
+    }
+
+    auto manifest = QJsonObject{{"shards", count}, {"wallSeconds", wall_seconds}, {"jobSeconds", job_seconds}, {"perShard", shards}};
+
+    for(const auto& category : categories)
+        manifest.insert(category.first, category.second);
+
+    qDebug() << "Merged " << count << " shards, slowest took " << wall_seconds << " s";
+
+    if(!writeJson(path + "/export_manifest.json", manifest))
+        return false;
+
+    if(!has_dedupe)
+        return true;
+
+    return writeJson(path + "/dedupe_report.json", QJsonObject{{"meshes", dedupe_meshes}, {"bytesSaved", dedupe_bytes}, {"categories", dedupe_categories}});
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "scheduling/ShardPlanner.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <map>
+
+// what one shard exported and how long every job took, and the merge of all shards into one result
+class ShardManifest
+{
+    using Jobs = std::map<QString, std::map<QString, double>>;
+
+public:
+    // times a job from construction to destruction under its category, timers of one name add up
+    class Timer
+    {
+    public:
+        Timer(const QString& category, const QString& name);
+        ~Timer();
+
+    private:
+        QString m_Category;
+        QString m_Name;
+        QElapsedTimer m_Timer;
+    };
+
+public:
+    // <path>/shards/<i>_of_<N>, also where a shard keeps its dedupe report
+    static QString shardPath(const QString& path, const Shard& shard);
+
+    // manifest.json of one shard with every job and the wall time of the process
+    static bool write(const QString& path, const Shard& shard, const double& seconds);
+
+    // export_manifest.json and dedupe_report.json over all shards, false while a shard is missing
+    static bool merge(const QString& path, const int& count);
+
+private:
+    static QMutex sm_JobsMutex;
+    static Jobs sm_Jobs;
+};
@@ -0,0 +1,91 @@
+#include "writer/StatsBackend.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+
+void StatsBackend::writeGeometry(const QString& path, const Geometry& geometry) const
+{
+    write(path,
+          geometry.m_Name,
+          QJsonObject{{"name", geometry.m_Name},
+                      {"vertices", qint64(geometry.m_Vertices.size())},
+                      {"triangles", qint64(geometry.m_Indices.size() / 3)}});
+}
+
+void StatsBackend::writeTrileSet(const QString& path, const QString& setName, const Triles& triles) const
+{
+    size_t vertices = 0;
+    size_t triangles = 0;
+
+    for(const auto& trile : triles)
+    {
+        vertices += trile.second.m_Vertices.size();
+        triangles += trile.second.m_Indices.size() / 3;
+    }
+
+    write(path,
+          setName,
+          QJsonObject{{"name", setName},
+                      {"triles", qint64(triles.size())},
+                      {"vertices", qint64(vertices)},
+                      {"triangles", qint64(triangles)}});
+}
+
+void StatsBackend::writeLevel(const QString& path, const Level& level, const LevelAnalysis& analysis) const
+{
+    size_t meshes = 0;
+    size_t instances = 0;
+    size_t vertices = 0;
+    size_t triangles = 0;
+
+    // vertices and triangles are what a renderer draws, instanced meshes count once per placement
+    for(const auto& batch : analysis.m_Batches)
+    {
+        meshes++;
+        instances++;
+        vertices += batch.m_Vertices.size();
+        triangles += batch.m_Indices.size() / 3;
+    }
+
+    for(const auto& group : analysis.m_InstanceGroups)
+    {
+        const auto& geometry = *group.second.m_Geometry;
+        const auto count = group.second.m_Instances.size();
+
+        meshes++;
+        instances += count;
+        vertices += geometry.m_Vertices.size() * count;
+        triangles += geometry.m_Indices.size() / 3 * count;
+    }
+
+    const auto alpha = QJsonObject{{"opaque", qint64(analysis.m_NumOpaque)},
+                                   {"cutout", qint64(analysis.m_NumCutout)},
+                                   {"translucent", qint64(analysis.m_NumTranslucent)}};
+
+    write(path,
+          level.m_LevelName,
+          QJsonObject{{"name", level.m_LevelName},
+                      {"batched", analysis.m_Batched},
+                      {"meshes", qint64(meshes)},
+                      {"instances", qint64(instances)},
+                      {"vertices", qint64(vertices)},
+                      {"triangles", qint64(triangles)},
+                      {"alpha", alpha}});
+}
+
+void StatsBackend::write(const QString& path, const QString& name, const QJsonObject& stats)
+{
+    QDir dir(path);
+
+    if(!dir.exists())
+        dir.mkpath(".");
+
+    QFile file(path + "/" + name + "_stats.json");
+
+    if(!file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return;
+
+    file.write(QJsonDocument(stats).toJson(QJsonDocument::JsonFormat::Indented));
+    file.close();
+}
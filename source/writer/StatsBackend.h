@@ -0,0 +1,17 @@
+#pragma once
+
+#include "writer/ExportBackend.h"
+
+#include <QtCore/QJsonObject>
+
+// <name>_stats.json with vertex, triangle, mesh and instance counts instead of geometry
+class StatsBackend : public ExportBackend
+{
+public:
+    void writeGeometry(const QString& path, const Geometry& geometry) const override;
+    void writeTrileSet(const QString& path, const QString& setName, const Triles& triles) const override;
+    void writeLevel(const QString& path, const Level& level, const LevelAnalysis& analysis) const override;
+
+private:
+    static void write(const QString& path, const QString& name, const QJsonObject& stats);
+};
@@ -0,0 +1,101 @@
+#include "writer/TrileSetWriter.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <assimp/scene.h>
+
+void TrileSetWriter::writeSet(const QString& setName, const Triles& triles)
+{
+    m_SaveName = setName;
+
+    for(const auto& trile : triles)
+    {
+        const auto mesh_id = addGeometry(trile.second);
+
+        if(!mesh_id)
+            continue;
+
+        const auto nodes = new aiNode*[1];
+        nodes[0] = new aiNode;
+        const auto node = nodes[0];
+
+        node->mName = trile.second.m_Name.toStdString();
+        node->mMeshes = new unsigned int[1];
+        node->mMeshes[0] = *mesh_id;
+        node->mNumMeshes = 1;
+
+        m_Scene->mRootNode->addChildren(1, nodes);
+    }
+
+    save();
+}
+
+void TrileSetWriter::writeManifest(const QString& path, const QString& setName, const Triles& triles, const QStringList& extensions, const Aliases& aliases)
+{
+    auto files = QJsonArray();
+
+    for(const auto& extension : extensions)
+        files.append(setName + "." + extension);
+
+    // objects are written in key order, empty triles are skipped by every writer
+    auto entries = QJsonArray();
+    auto entry_ids = std::map<int, qsizetype>();
+    auto object = qint64(0);
+    auto first_face = qint64(0);
+    auto texture = QString();
+
+    for(const auto& trile : triles)
+    {
+        const auto& geometry = trile.second;
+        const auto num_faces = qint64(geometry.m_Indices.size() / 3);
+
+        if(geometry.m_Vertices.empty() || num_faces == 0)
+            continue;
+
+        texture = geometry.m_Texture.m_TextureName;
+
+        entry_ids.insert({trile.first, entries.size()});
+        entries.append(QJsonObject{{"key", trile.first},
+                                   {"name", geometry.m_Name},
+                                   {"object", object++},
+                                   {"firstFace", first_face},
+                                   {"faceCount", num_faces},
+                                   {"vertexCount", qint64(geometry.m_Vertices.size())}});
+
+        first_face += num_faces;
+    }
+
+    for(const auto& alias : aliases)
+    {
+        const auto entry_find_iter = entry_ids.find(alias.second);
+
+        if(entry_find_iter == entry_ids.cend())
+            continue;
+
+        auto entry = entries[entry_find_iter->second].toObject();
+
+        entry.insert("key", alias.first);
+        entry.insert("aliasOf", alias.second);
+
+        entries.append(entry);
+    }
+
+    const auto manifest = QJsonObject{{"set", setName}, {"files", files}, {"texture", texture}, {"triles", entries}};
+
+    QDir dir(path);
+
+    if(!dir.exists())
+        dir.mkpath(".");
+
+    QFile file(path + "/" + setName + ".json");
+
+    if(!file.open(QIODevice::OpenModeFlag::WriteOnly))
+        return;
+
+    file.write(QJsonDocument(manifest).toJson(QJsonDocument::JsonFormat::Indented));
+    file.close();
+}
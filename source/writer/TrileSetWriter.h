@@ -0,0 +1,26 @@
+#pragma once
+
+#include "model/Geometry.h"
+
+#include "writer/Writer.h"
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <map>
+
+class TrileSetWriter : public Writer
+{
+public:
+    using Triles = std::map<int, Geometry>;
+    using Aliases = std::map<int, int>;
+
+    using Writer::Writer;
+
+    // one object per trile key, all triles share one material and one texture
+    void writeSet(const QString& setName, const Triles& triles);
+
+    // <set>.json, maps trile keys to object index and face range in every written file
+    // deduplicated keys share the entry of the trile they were collapsed into
+    static void writeManifest(const QString& path, const QString& setName, const Triles& triles, const QStringList& extensions, const Aliases& aliases = {});
+};
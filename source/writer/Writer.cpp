@@ -1,10 +1,14 @@
 #include "writer/Writer.h"
 
+#include "processor/LevelBatcher.h"
+
+#include "profiling/Trace.h"
+
+#include "texture/AlphaClassifier.h"
+
 #include <QtCore/QFile>
 #include <QtCore/QDir>
 
-#include <QtGui/QImage>
-
 #include <assimp/Exporter.hpp>
 #include <assimp/scene.h>
 
@@ -75,11 +79,10 @@ void Writer::deallocateScene()
 
 Writer::MeshId Writer::addGeometry(const Geometry& geometry)
 {
-    const auto mesh_allocation = allocateMesh();
-    const auto material_allocation = allocateMaterial();
+    TraceSpan span("add geometry", geometry.m_Name, ProfileStage::SceneBuild);
 
+    const auto mesh_allocation = allocateMesh();
     const auto mesh = mesh_allocation.second;
-    const auto material = material_allocation.second;
 
     // load vertices
     const auto& num_vertices = geometry.m_Vertices.size();
@@ -129,8 +132,30 @@ Writer::MeshId Writer::addGeometry(const Geometry& geometry)
     }
 
     mesh->mName = geometry.m_Name.toStdString();
-    
+
+    // geometries with the same texture and material settings share one material and one texture copy
+    const auto material_key = LevelBatcher::materialKey(geometry);
+    const auto material_find_iter = m_MaterialIds.find(material_key);
+
+    if(material_find_iter != m_MaterialIds.cend())
+    {
+        mesh->mMaterialIndex = material_find_iter->second;
+
+        return mesh_allocation.first;
+    }
+
+    // test on transparency, classified once at parse time
+    const auto alpha = !geometry.m_IsPlane || geometry.m_Texture.m_Alpha != TextureAlpha::Unknown
+                           ? geometry.m_Texture.m_Alpha
+                           : AlphaClassifier::classify(geometry.m_Texture.m_TextureOrgFile);
+
+    if(geometry.m_IsPlane && alpha == TextureAlpha::Unknown)
+        return {};
+
     // load material
+    const auto material_allocation = allocateMaterial();
+    const auto material = material_allocation.second;
+
     aiString material_name(geometry.m_Texture.m_TextureName.toStdString());
     aiString diffuse_texture_filename(geometry.m_Texture.m_TextureName.toStdString());
     aiString opacity_texture_filename(geometry.m_Texture.m_TextureName.toStdString());
@@ -144,29 +169,11 @@ Writer::MeshId Writer::addGeometry(const Geometry& geometry)
     result = material->AddProperty(&opacity, 1, AI_MATKEY_OPACITY);
     result = material->AddProperty(&double_sided, 1, AI_MATKEY_TWOSIDED);
 
-    // test on transparency
-    if(geometry.m_IsPlane)
-    {
-        QImage texture(geometry.m_Texture.m_TextureOrgFile);
-
-        if(texture.isNull())
-            return {};
-        
-        if(texture.hasAlphaChannel())
-        {
-            bool use_opacity = false;
-
-            for(int x = 0; x < texture.width() && !use_opacity; x++)
-                for(int y = 0; y < texture.height() && !use_opacity; y++)
-                    use_opacity = texture.pixelColor(x, y).alphaF() < 1.0f;
-
-            if(use_opacity)
-                result = material->AddProperty(&opacity_texture_filename, AI_MATKEY_TEXTURE_OPACITY(0));
-        }    
-
-    }
+    if(geometry.m_IsPlane && alpha != TextureAlpha::Opaque)
+        result = material->AddProperty(&opacity_texture_filename, AI_MATKEY_TEXTURE_OPACITY(0));
 
     m_Textures.push_back(std::make_pair(geometry.m_Texture.m_TextureOrgFile, m_Path + "/" + geometry.m_Texture.m_TextureName));
+    m_MaterialIds.insert({material_key, material_allocation.first});
 
     mesh->mMaterialIndex = material_allocation.first;
 
@@ -176,9 +183,13 @@ Writer::MeshId Writer::addGeometry(const Geometry& geometry)
 void Writer::save()
 {
     // save
+    TraceSpan export_span("assimp export", m_SaveName, ProfileStage::Export);
+
     Assimp::Exporter exporter;
     aiReturn success = exporter.Export(m_Scene, "obj", m_Path.toStdString() + "/" + m_SaveName.toStdString() + ".obj");
-    
+
+    export_span.end();
+
     if(success != aiReturn_SUCCESS)
     {
         std::string export_error_string(exporter.GetErrorString());
@@ -193,6 +204,8 @@ void Writer::save()
         if(!texture_out_dir.exists())
             texture_out_dir.mkdir(".");
 
+        TraceSpan copy_span("copy texture", t.first, ProfileStage::TextureCopy);
+
         QFile texture(t.first);
         texture.copy(t.second);
     }
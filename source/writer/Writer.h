@@ -4,6 +4,8 @@
 
 #include <QtCore/QString>
 
+#include <map>
+
 struct aiScene;
 struct aiMesh;
 struct aiMaterial;
@@ -39,4 +41,5 @@ protected:
     
     aiScene* m_Scene;
     Textures m_Textures;
+    std::map<QString, unsigned int> m_MaterialIds;
 };